@@ -0,0 +1,227 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <substrate/internal/cpu_features>
+#include "benchmark"
+
+#if defined(SUBSTRATE_ARCH_X86)
+#	if defined(_MSC_VER) && !defined(__clang__)
+#		include <intrin.h>
+#	else
+#		include <x86intrin.h>
+#	endif
+#endif
+
+namespace benchmark
+{
+	namespace
+	{
+		struct result_t final
+		{
+			const char *suite;
+			std::string name;
+			size_t bytes;
+			config_t config;
+			uint64_t iterations;
+			double nanosecondsPerCall;
+			double cycles;
+		};
+
+		std::vector<std::pair<const char *, benchmarkFunction_t>> &registry() noexcept
+		{
+			static std::vector<std::pair<const char *, benchmarkFunction_t>> benchmarks{};
+			return benchmarks;
+		}
+
+		config_t currentConfig{};
+		const char *currentSuite{""};
+		bool jsonOutput{false};
+		size_t evictionSize{64U * 1024U * 1024U};
+		std::vector<result_t> results{};
+
+#if defined(SUBSTRATE_ARCH_X86)
+		constexpr bool haveCycles{true};
+#else
+		constexpr bool haveCycles{false};
+#endif
+
+		void printString(const char *str) noexcept
+		{
+			std::putchar('"');
+			for (; *str; ++str)
+			{
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+				if (*str == '"' || *str == '\\')
+					std::putchar('\\');
+				std::putchar(*str);
+			}
+			std::putchar('"');
+		}
+
+		void printJSON() noexcept
+		{
+			std::printf("{\n\t\"cycleCounter\": %s,\n\t\"results\":\n\t[", haveCycles ? "\"tsc\"" : "null");
+			bool first{true};
+			for (const auto &result : results)
+			{
+				std::printf(first ? "\n\t\t{\"suite\": " : ",\n\t\t{\"suite\": ");
+				first = false;
+				printString(result.suite);
+				std::printf(", \"name\": ");
+				printString(result.name.c_str());
+				std::printf(", \"bytes\": %zu, \"cache\": \"%s\", \"threads\": %zu, \"iterations\": %llu, "
+					"\"nsPerOp\": %.3f, \"gbPerSecond\": %.6f, \"cyclesPerByte\": ", result.bytes,
+					result.config.cold ? "cold" : "warm", result.config.threads,
+					static_cast<unsigned long long>(result.iterations), result.nanosecondsPerCall,
+					double(result.bytes * result.config.threads) / result.nanosecondsPerCall);
+				if (haveCycles)
+					std::printf("%.4f}", result.cycles);
+				else
+					std::printf("null}");
+			}
+			std::printf("\n\t]\n}\n");
+		}
+
+		bool parseSize(const char *const value, size_t &size) noexcept
+		{
+			char *end{};
+			const auto parsed{std::strtoull(value, &end, 10)};
+			if (!end || *end || end == value)
+				return false;
+			size = size_t(parsed);
+			return true;
+		}
+	} // namespace
+
+	registration_t::registration_t(const char *const name, const benchmarkFunction_t function) noexcept
+		{ registry().emplace_back(name, function); }
+
+	const config_t &config() noexcept { return currentConfig; }
+
+	// `iterations` counts calls across all threads, and `cycles` is summed over the threads as well
+	void report(const char *const name, const size_t bytes, const uint64_t iterations,
+		const clock_t::duration elapsed, const uint64_t cycles) noexcept
+	{
+		const auto threads{currentConfig.threads};
+		const auto nanoseconds{std::chrono::duration<double, std::nano>{elapsed}.count()};
+		// Wall time per call as seen by each thread
+		const auto perCall{nanoseconds * double(threads) / double(iterations)};
+		const auto totalBytes{double(bytes) * double(iterations)};
+		const auto cyclesPerByte{totalBytes ? double(cycles) / totalBytes : 0.0};
+		results.push_back({currentSuite, name, bytes, currentConfig, iterations, perCall, cyclesPerByte});
+		if (jsonOutput)
+			return;
+		// Bytes per nanosecond is GB/s
+		std::printf("%-32s %10zu B %12.2f ns/op %10.3f GB/s", name, bytes, perCall,
+			totalBytes / nanoseconds);
+		if (haveCycles)
+			std::printf(" %10.3f c/B", cyclesPerByte);
+		std::printf("\n");
+	}
+
+	std::vector<uint8_t> makeData(const size_t length)
+	{
+		std::vector<uint8_t> data(length);
+		uint32_t state{UINT32_C(0x12345678)};
+		for (auto &value : data)
+		{
+			state = state * UINT32_C(1103515245) + UINT32_C(12345);
+			value = uint8_t(state >> 24U);
+		}
+		return data;
+	}
+
+	std::vector<size_t> sizes(const size_t minimum, const size_t maximum)
+	{
+		std::vector<size_t> result{};
+		for (auto size{minimum}; size <= maximum; size *= 4U)
+			result.push_back(size);
+		return result;
+	}
+
+	uint64_t cycles() noexcept
+	{
+#if defined(SUBSTRATE_ARCH_X86)
+		return __rdtsc();
+#else
+		return 0U;
+#endif
+	}
+
+	void evictCaches() noexcept
+	{
+		static std::vector<uint8_t> buffer(evictionSize);
+		// Dirtying one byte per cache line is enough to pull every line in
+		for (size_t offset{}; offset < buffer.size(); offset += 64U)
+			++buffer[offset];
+		doNotOptimise(buffer.data());
+	}
+} // namespace benchmark
+
+/*
+ * Runs every registered suite, or just those whose names contain one of the non-option arguments. Options:
+ *   --json          print the results as one JSON document at the end instead of as a table
+ *   --cold          add a pass with the caches evicted before every call
+ *   --threads[=N]   add a pass with every operation run on N threads at once (default: all of them)
+ *   --evict=MiB     size of the buffer used to evict the caches (default: 64)
+ */
+int main(int argCount, char **argList)
+{
+	std::vector<benchmark::config_t> configs{{}};
+	std::vector<const char *> filters{};
+	for (int arg{1}; arg < argCount; ++arg)
+	{
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		const char *const value{argList[arg]};
+		size_t size{};
+		if (!std::strcmp(value, "--json"))
+			benchmark::jsonOutput = true;
+		else if (!std::strcmp(value, "--cold"))
+			configs.push_back({true, 1U});
+		else if (!std::strcmp(value, "--threads"))
+			configs.push_back({false, std::max(std::thread::hardware_concurrency(), 1U)});
+		else if (!std::strncmp(value, "--threads=", 10U) && benchmark::parseSize(value + 10, size) && size)
+			configs.push_back({false, size});
+		else if (!std::strncmp(value, "--evict=", 8U) && benchmark::parseSize(value + 8, size) && size)
+			benchmark::evictionSize = size * 1024U * 1024U;
+		else if (value[0] == '-')
+		{
+			std::fprintf(stderr, "Unknown option %s\n", value);
+			return 1;
+		}
+		else
+			filters.push_back(value);
+	}
+
+	for (const auto &suite : benchmark::registry())
+	{
+		bool selected{filters.empty()};
+		for (const auto *const filter : filters)
+		{
+			if (std::strstr(suite.first, filter))
+				selected = true;
+		}
+		if (!selected)
+			continue;
+		for (const auto &config : configs)
+		{
+			benchmark::currentConfig = config;
+			benchmark::currentSuite = suite.first;
+			if (!benchmark::jsonOutput)
+				std::printf("# %s (%s, %zu thread%s)\n", suite.first, config.cold ? "cold" : "warm", config.threads,
+					config.threads == 1U ? "" : "s");
+			suite.second();
+		}
+	}
+
+	if (benchmark::jsonOutput)
+		benchmark::printJSON();
+	return 0;
+}
+
+/* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
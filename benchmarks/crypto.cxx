@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <substrate/crypto/ctr_drbg>
+#include <substrate/crypto/hmac>
+#include <substrate/crypto/merkle>
+#include <substrate/crypto/sha256>
+#include <substrate/crypto/sha512>
+#include <substrate/crypto/twofish>
+#include <substrate/crypto/twofish_parallel>
+#include <substrate/span>
+#include "benchmark"
+
+using substrate::span;
+
+namespace
+{
+	void shaBenchmarks()
+	{
+		const auto data{benchmark::makeData(64U * 1024U * 1024U)};
+		for (const auto size : benchmark::sizes())
+		{
+			const span<const uint8_t> input{data.data(), size};
+			benchmark::measure("sha256", size,
+				[&]() { benchmark::doNotOptimise(substrate::crypto::sha256_t{}.hash(input)); });
+			benchmark::measure("sha512", size,
+				[&]() { benchmark::doNotOptimise(substrate::crypto::sha512_t{}.hash(input)); });
+		}
+	}
+
+	// Small messages are where caching the padded key states pays off
+	void hmacBenchmarks()
+	{
+		const auto data{benchmark::makeData(64U * 1024U * 1024U)};
+		const auto key{benchmark::makeData(32U)};
+		substrate::crypto::hmac_t<substrate::crypto::sha256_t> hmac256{key};
+		substrate::crypto::hmac_t<substrate::crypto::sha512_t> hmac512{key};
+		for (const auto size : benchmark::sizes())
+		{
+			const span<const uint8_t> input{data.data(), size};
+			benchmark::measureSerial("hmac-sha256", size, [&]() { benchmark::doNotOptimise(hmac256.mac(input)); });
+			benchmark::measureSerial("hmac-sha512", size, [&]() { benchmark::doNotOptimise(hmac512.mac(input)); });
+		}
+	}
+
+	// Hashes 1MiB worth of equally sized messages, one at a time and then all together
+	void sha256ManyBenchmarks()
+	{
+		const auto data{benchmark::makeData(1024U * 1024U)};
+		for (size_t size{64U}; size <= 64U * 1024U; size *= 4U)
+		{
+			const auto serialName{"sha256 (serial) x" + std::to_string(size)};
+			const auto manyName{"sha256_many x" + std::to_string(size)};
+			std::vector<span<const uint8_t>> messages{};
+			for (size_t offset{}; offset + size <= data.size(); offset += size)
+				messages.emplace_back(data.data() + offset, size);
+			std::vector<substrate::crypto::sha256_t::digest_t> digests(messages.size());
+			substrate::crypto::sha256_t sha256{};
+
+			benchmark::measureSerial(serialName.c_str(), data.size(), [&]()
+			{
+				for (size_t i{}; i < messages.size(); ++i)
+					digests[i] = sha256.hash(messages[i]);
+				benchmark::doNotOptimise(digests);
+			});
+			benchmark::measureSerial(manyName.c_str(), data.size(), [&]()
+			{
+				substrate::crypto::sha256_many(messages, digests);
+				benchmark::doNotOptimise(digests);
+			});
+		}
+	}
+
+	// Runs the block primitives back to back over a buffer, one 16 byte block at a time, then the bulk paths
+	void twofishBenchmarks()
+	{
+		std::array<uint8_t, 32> key{{}};
+		for (size_t i{}; i < key.size(); ++i)
+			key[i] = uint8_t(i);
+		std::vector<uint32_t> buffer((64U * 1024U * 1024U) / sizeof(uint32_t));
+
+		substrate::crypto::twofish_ctr_t ctr{};
+		ctr.set_key(key);
+		ctr.set_iv(std::array<uint8_t, 8>{{}});
+		substrate::crypto::twofish_cbc_t cbc{};
+		cbc.set_key(key);
+		cbc.set_iv(std::array<uint8_t, 16>{{}});
+
+		for (const auto size : benchmark::sizes(16U, 1024U * 1024U))
+		{
+			const auto words{size / sizeof(uint32_t)};
+			benchmark::measureSerial("twofish CTR encrypt_blk", size, [&]()
+			{
+				for (size_t i{}; i < words; i += 4U)
+					ctr.encrypt_blk(buffer.data() + i, 4U, buffer.data() + i, 4U);
+				benchmark::doNotOptimise(buffer);
+			});
+			benchmark::measureSerial("twofish CBC decrypt_blk", size, [&]()
+			{
+				for (size_t i{}; i < words; i += 4U)
+					cbc.decrypt_blk(buffer.data() + i, 4U, buffer.data() + i, 4U);
+				benchmark::doNotOptimise(buffer);
+			});
+		}
+
+		for (const auto size : benchmark::sizes())
+		{
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			const span<uint8_t> bytes{reinterpret_cast<uint8_t *>(buffer.data()), size};
+			benchmark::measureSerial("twofish CTR crypt", size, [&]()
+			{
+				ctr.crypt(bytes, bytes, 0U);
+				benchmark::doNotOptimise(buffer);
+			});
+			benchmark::measureSerial("twofish CBC decrypt", size, [&]()
+			{
+				benchmark::doNotOptimise(cbc.decrypt(bytes, bytes));
+				benchmark::doNotOptimise(buffer);
+			});
+			benchmark::measureSerial("twofish CTR crypt_parallel", size, [&]()
+			{
+				substrate::crypto::crypt_parallel(ctr, bytes, bytes, 0U);
+				benchmark::doNotOptimise(buffer);
+			});
+			benchmark::measureSerial("twofish CBC decrypt_parallel", size, [&]()
+			{
+				benchmark::doNotOptimise(substrate::crypto::decrypt_parallel(cbc, bytes, bytes));
+				benchmark::doNotOptimise(buffer);
+			});
+		}
+	}
+
+	// Whole tree builds against plain SHA-256, then touching a single chunk of an already built tree
+	void merkleBenchmarks()
+	{
+		const auto data{benchmark::makeData(64U * 1024U * 1024U)};
+		const span<const uint8_t> input{data.data(), data.size()};
+		benchmark::measure("sha256", data.size(),
+			[&]() { benchmark::doNotOptimise(substrate::crypto::sha256_t{}.hash(input)); });
+		for (size_t chunkSize{4096U}; chunkSize <= 4U * 1024U * 1024U; chunkSize *= 16U)
+		{
+			substrate::crypto::merkle_t tree{chunkSize};
+			const auto hashName{"merkle hash x" + std::to_string(chunkSize)};
+			const auto rehashName{"merkle rehash x" + std::to_string(chunkSize)};
+			benchmark::measureSerial(hashName.c_str(), data.size(),
+				[&]() { benchmark::doNotOptimise(tree.hash(input)); });
+			const std::array<size_t, 1> changed{{tree.chunks() / 2U}};
+			benchmark::measureSerial(rehashName.c_str(), chunkSize, [&]()
+				{ benchmark::doNotOptimise(tree.rehash(input, changed)); });
+		}
+	}
+
+	// Token sized and bulk draws from each thread's generator, against asking the OS every time
+	void drbgBenchmarks()
+	{
+		for (const auto size : benchmark::sizes(16U, 1024U * 1024U))
+		{
+			std::vector<uint8_t> output(size);
+			benchmark::measure("ctrDrbg_t", size, [&]()
+			{
+				// Each thread needs its own buffer for a threaded pass
+				thread_local std::vector<uint8_t> buffer{};
+				buffer.resize(output.size());
+				substrate::crypto::ctrDrbg_t::thread_instance().fill(buffer);
+				benchmark::doNotOptimise(buffer.data());
+			});
+			benchmark::measure("ctrDrbg_t::entropy", size, [&]()
+			{
+				thread_local std::vector<uint8_t> buffer{};
+				buffer.resize(output.size());
+				substrate::crypto::ctrDrbg_t::entropy(buffer.data(), buffer.size());
+				benchmark::doNotOptimise(buffer.data());
+			});
+		}
+	}
+
+	const benchmark::registration_t registration{"sha", shaBenchmarks};
+	const benchmark::registration_t hmacRegistration{"hmac", hmacBenchmarks};
+	const benchmark::registration_t manyRegistration{"sha256-many", sha256ManyBenchmarks};
+	const benchmark::registration_t twofishRegistration{"twofish", twofishBenchmarks};
+	const benchmark::registration_t merkleRegistration{"merkle", merkleBenchmarks};
+	const benchmark::registration_t drbgRegistration{"drbg", drbgBenchmarks};
+} // namespace
+
+/* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <substrate/hash>
+#include <substrate/span>
+#include "benchmark"
+
+using substrate::span;
+
+namespace
+{
+	void hashBenchmarks()
+	{
+		const auto data{benchmark::makeData(64U * 1024U * 1024U)};
+		for (const auto size : benchmark::sizes())
+		{
+			const span<const uint8_t> input{data.data(), size};
+			benchmark::measure("xxh3_64", size, [&]() { benchmark::doNotOptimise(substrate::xxh3_64(input)); });
+			benchmark::measure("xxh3_128", size, [&]() { benchmark::doNotOptimise(substrate::xxh3_128(input)); });
+			benchmark::measure("murmur128", size, [&]() { benchmark::doNotOptimise(substrate::murmur128(input, 0U)); });
+			benchmark::measure("crc32", size, [&]() { benchmark::doNotOptimise(substrate::crc32(input)); });
+			benchmark::measure("crc32c", size, [&]() { benchmark::doNotOptimise(substrate::crc32c(input)); });
+			benchmark::measure("sysv_checksum", size, [&]() { benchmark::doNotOptimise(substrate::sysv_checksum(input)); });
+		}
+	}
+
+	void sysvParallelBenchmarks()
+	{
+		const auto data{benchmark::makeData(256U * 1024U * 1024U)};
+		for (size_t size{1024U * 1024U}; size <= data.size(); size *= 4U)
+		{
+			const span<const uint8_t> input{data.data(), size};
+			benchmark::measure("sysv_checksum", size, [&]() { benchmark::doNotOptimise(substrate::sysv_checksum(input)); });
+			benchmark::measure("sysv_checksum_parallel", size,
+				[&]() { benchmark::doNotOptimise(substrate::sysv_checksum_parallel(input)); });
+		}
+	}
+
+	const benchmark::registration_t registration{"hash", hashBenchmarks};
+	const benchmark::registration_t sysvRegistration{"sysv-parallel", sysvParallelBenchmarks};
+} // namespace
+
+/* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
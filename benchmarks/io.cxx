@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <substrate/fd>
+#include <substrate/advanced/buffered_io>
+#include "benchmark"
+
+namespace
+{
+	using substrate::advanced::bufferedReader_t;
+	using substrate::advanced::bufferedWriter_t;
+	using substrate::advanced::readable_t;
+	using substrate::advanced::writeable_t;
+
+	constexpr const char *scratchFile{"benchmark.io"};
+	// Each record is a little-endian 32-bit word, a big-endian 16-bit word and a little-endian 64-bit word
+	constexpr size_t recordSize{14U};
+
+	void writeRecords(const writeable_t &file, const size_t count) noexcept
+	{
+		for (size_t i{}; i < count; ++i)
+		{
+			SUBSTRATE_NOWARN_UNUSED(const bool written) = file.writeLE(uint32_t(i)) &&
+				file.writeBE(uint16_t(i)) && file.writeLE(uint64_t{i});
+		}
+	}
+
+	uint64_t readRecords(const readable_t &file, const size_t count) noexcept
+	{
+		uint64_t sum{};
+		for (size_t i{}; i < count; ++i)
+		{
+			uint32_t a{};
+			uint16_t b{};
+			uint64_t c{};
+			if (!file.readLE(a) || !file.readBE(b) || !file.readLE(c))
+				break;
+			sum += a + b + c;
+		}
+		return sum;
+	}
+
+	// Parsing and writing a file a field at a time, straight through fd_t and through the buffered adaptors
+	void ioBenchmarks()
+	{
+		const substrate::fd_t file{scratchFile, O_RDWR | O_CREAT | O_TRUNC, substrate::normalMode};
+		if (!file.valid())
+			return;
+		for (const auto size : benchmark::sizes(recordSize * 64U, recordSize * 16384U))
+		{
+			const auto count{size / recordSize};
+			benchmark::measureSerial("fd_t write fields", size, [&]()
+			{
+				SUBSTRATE_NOWARN_UNUSED(const bool rewound) = file.head();
+				writeRecords(file, count);
+			});
+			benchmark::measureSerial("bufferedWriter_t write fields", size, [&]()
+			{
+				SUBSTRATE_NOWARN_UNUSED(const bool rewound) = file.head();
+				const bufferedWriter_t writer{file};
+				writeRecords(writer, count);
+			});
+			benchmark::measureSerial("fd_t read fields", size, [&]()
+			{
+				SUBSTRATE_NOWARN_UNUSED(const bool rewound) = file.head();
+				benchmark::doNotOptimise(readRecords(file, count));
+			});
+			benchmark::measureSerial("bufferedReader_t read fields", size, [&]()
+			{
+				SUBSTRATE_NOWARN_UNUSED(const bool rewound) = file.head();
+				const bufferedReader_t reader{file};
+				benchmark::doNotOptimise(readRecords(reader, count));
+			});
+		}
+		unlink(scratchFile);
+	}
+
+	const benchmark::registration_t registration{"bufferedIO", ioBenchmarks};
+
+	// Messages written per call, each a fixed size header followed by a payload
+	constexpr size_t messages{64U};
+	constexpr size_t headerSize{16U};
+
+	// Writing header plus payload messages as two writes, by copying them together first, and as one gather write
+	void vectoredBenchmarks()
+	{
+		const substrate::fd_t file{scratchFile, O_RDWR | O_CREAT | O_TRUNC, substrate::normalMode};
+		if (!file.valid())
+			return;
+		const std::array<uint8_t, headerSize> header{};
+		for (const auto payloadSize : benchmark::sizes(16U, 16384U))
+		{
+			const std::vector<uint8_t> payload(payloadSize);
+			std::vector<uint8_t> message(headerSize + payloadSize);
+			const auto size{messages * message.size()};
+			benchmark::measureSerial("write() header, payload", size, [&]()
+			{
+				SUBSTRATE_NOWARN_UNUSED(const bool rewound) = file.head();
+				for (size_t i{}; i < messages; ++i)
+				{
+					SUBSTRATE_NOWARN_UNUSED(const bool written) = file.write(header) &&
+						file.write(payload.data(), payload.size());
+				}
+			});
+			benchmark::measureSerial("copy then write()", size, [&]()
+			{
+				SUBSTRATE_NOWARN_UNUSED(const bool rewound) = file.head();
+				for (size_t i{}; i < messages; ++i)
+				{
+					std::memcpy(message.data(), header.data(), header.size());
+					std::memcpy(message.data() + header.size(), payload.data(), payload.size());
+					SUBSTRATE_NOWARN_UNUSED(const bool written) = file.write(message.data(), message.size());
+				}
+			});
+			const std::array<substrate::span<const uint8_t>, 2> buffers
+				{{substrate::span<const uint8_t>{header}, substrate::span<const uint8_t>{payload}}};
+			benchmark::measureSerial("writeVec() header, payload", size, [&]()
+			{
+				SUBSTRATE_NOWARN_UNUSED(const bool rewound) = file.head();
+				for (size_t i{}; i < messages; ++i)
+					SUBSTRATE_NOWARN_UNUSED(const bool written) = file.writeVec(buffers);
+			});
+		}
+		unlink(scratchFile);
+	}
+
+	const benchmark::registration_t vectoredRegistration{"vectoredIO", vectoredBenchmarks};
+} // namespace
+
+/* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
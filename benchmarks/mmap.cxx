@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <substrate/mmap>
+#include "benchmark"
+
+#ifndef _WIN32
+namespace
+{
+	using substrate::mmap_t;
+
+	// Reads per call; enough that a call takes long enough to time regardless of the region's size
+	constexpr size_t reads{65536U};
+
+	std::string describe(const mmap_t &map)
+	{
+		if (map.page_size() >= substrate::hugePageSize2MiB)
+			return std::to_string(map.page_size() >> 20U) + "M pages";
+		if (map.transparent_huge_bytes() == map.length())
+			return "THP";
+		if (map.transparent_huge_bytes())
+			return "partly THP";
+		return std::to_string(map.page_size() >> 10U) + "K pages";
+	}
+
+	// Independent 8-byte reads from random spots in the region; past a few MiB most of them miss the TLB
+	void measureRandomReads(mmap_t &map)
+	{
+		auto *const data{map.address<uint64_t>()};
+		const auto words{map.length() / sizeof(uint64_t)};
+		// Touch every page first so the timings don't include faulting them in
+		for (size_t word{}; word < words; word += 512U)
+			data[word] = word;
+		const auto name{"random " + std::to_string(map.length() >> 20U) + "MiB, " + describe(map)};
+
+		uint64_t state{UINT64_C(0x0123456789ABCDEF)};
+		benchmark::measureSerial(name.c_str(), reads * sizeof(uint64_t), [&]()
+		{
+			uint64_t sum{};
+			for (size_t i{}; i < reads; ++i)
+			{
+				state = (state * UINT64_C(6364136223846793005)) + UINT64_C(1442695040888963407);
+				// words is a power of 2, and the high bits of the LCG are the random ones
+				sum += data[(state >> 32U) & (words - 1U)];
+			}
+			benchmark::doNotOptimise(sum);
+		});
+	}
+
+	/*
+	 * Random access to normal (4K) pages versus huge pages. The huge pages come from the hugetlb pool if it
+	 * has enough in it (see /proc/sys/vm/nr_hugepages), otherwise from transparent huge pages if they're
+	 * enabled; the benchmark names say which were had.
+	 */
+	void hugePageBenchmarks()
+	{
+		for (const auto size : benchmark::sizes(4U * 1024U * 1024U, 256U * 1024U * 1024U))
+		{
+			mmap_t normal{-1, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS};
+			if (!normal.valid())
+				continue;
+#ifdef MADV_NOHUGEPAGE
+			static_cast<void>(normal.advise(MADV_NOHUGEPAGE));
+#endif
+			measureRandomReads(normal);
+			normal = {};
+
+			auto huge{mmap_t::huge(size, PROT_READ | PROT_WRITE)};
+			if (huge.valid())
+				measureRandomReads(huge);
+		}
+	}
+
+	const benchmark::registration_t registration{"hugePages", hugePageBenchmarks};
+
+	// Writes a byte to every page, which is what faults them in when the mapping wasn't populated up front
+	void writePages(mmap_t &map)
+	{
+		if (!map.valid())
+			return;
+		auto *const data{map.address<uint8_t>()};
+		for (size_t offset{}; offset < map.length(); offset += 4096U)
+			data[offset] = uint8_t(offset);
+		benchmark::doNotOptimise(data[0]);
+	}
+
+	/*
+	 * Making a fresh mapping and writing to all of it: faulting pages in one at a time on first touch,
+	 * against having the kernel populate the mapping as it's made or populate() do it across the workers.
+	 */
+	void populateBenchmarks()
+	{
+		for (const auto size : benchmark::sizes(16U * 1024U * 1024U, 256U * 1024U * 1024U))
+		{
+			// Skip sizes we can't get a mapping for at all, rather than timing failed mmap() calls
+			if (!mmap_t{-1, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS}.valid())
+				continue;
+			benchmark::measureSerial("first touch", size, [&]()
+			{
+				mmap_t map{-1, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS};
+				writePages(map);
+			});
+			benchmark::measureSerial("MAP_POPULATE", size, [&]()
+			{
+				mmap_t map{-1, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE};
+				writePages(map);
+			});
+			benchmark::measureSerial("populate()", size, [&]()
+			{
+				mmap_t map{-1, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS};
+				SUBSTRATE_NOWARN_UNUSED(const bool populated) = map.populate(substrate::populateMode_t::write);
+				writePages(map);
+			});
+		}
+	}
+
+	const benchmark::registration_t populateRegistration{"populate", populateBenchmarks};
+} // namespace
+#endif
+
+/* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
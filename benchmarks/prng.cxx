@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <substrate/prng>
+#include "benchmark"
+
+namespace
+{
+	// Draws `bytes` worth of output from a freshly seeded generator, so every thread gets its own state
+	template<typename prng_t, typename seed_t> void measurePRNG(const char *const name, const seed_t &seed)
+	{
+		using result_t = decltype(prng_t{seed}());
+		for (const auto size : benchmark::sizes())
+		{
+			const auto count{size / sizeof(result_t)};
+			benchmark::measure(name, size, [&]()
+			{
+				prng_t rng{seed};
+				result_t sum{};
+				for (size_t i{}; i < count; ++i)
+					sum ^= rng();
+				benchmark::doNotOptimise(sum);
+			});
+		}
+	}
+
+	// Bulk output through fill(); seeding jumps the lanes apart, which is too slow to repeat on every call
+	template<typename prng_t, typename seed_t> void measureFill(const char *const name, const seed_t &seed)
+	{
+		prng_t rng{seed};
+		for (const auto size : benchmark::sizes(64U))
+		{
+			std::vector<uint64_t> values(size / sizeof(uint64_t));
+			benchmark::measureSerial(name, size, [&]()
+			{
+				rng.fill(values);
+				benchmark::doNotOptimise(values.data());
+			});
+		}
+	}
+
+	// Turning generator output into count values of a distribution, with the sizes given in bytes of output
+	template<typename value_t, typename prng_t, typename draw_t> void measureDistribution(const char *const name,
+		prng_t rng, draw_t &&draw)
+	{
+		for (const auto size : benchmark::sizes(1024U, 4U * 1024U * 1024U))
+		{
+			std::vector<value_t> values(size / sizeof(value_t));
+			benchmark::measureSerial(name, size, [&]()
+			{
+				draw(rng, values);
+				benchmark::doNotOptimise(values.data());
+			});
+		}
+	}
+
+	void distributionBenchmarks()
+	{
+		constexpr std::array<uint64_t, 4> seed{{
+			UINT64_C(0x0123456789ABCDEF), UINT64_C(0xFEDCBA9876543210),
+			UINT64_C(0x0F1E2D3C4B5A6978), UINT64_C(0x8796A5B4C3D2E1F0)
+		}};
+		const substrate::xoshiro256pp_t scalar{seed};
+		const substrate::xoshiro256x8pp_t lanes{seed};
+		constexpr uint64_t bound{1000003U};
+
+		measureDistribution<uint64_t>("rng() % n", scalar, [](substrate::xoshiro256pp_t &rng, std::vector<uint64_t> &values)
+		{
+			for (auto &value : values)
+				value = rng() % bound;
+		});
+		measureDistribution<uint64_t>("bounded_t", scalar, [](substrate::xoshiro256pp_t &rng, std::vector<uint64_t> &values)
+			{ substrate::bounded_t<uint64_t>{bound}.fill(rng, values); });
+		measureDistribution<uint64_t>("bounded_t x8", lanes, [](substrate::xoshiro256x8pp_t &rng, std::vector<uint64_t> &values)
+			{ substrate::bounded_t<uint64_t>{bound}.fill(rng, values); });
+		measureDistribution<uint64_t>("std::uniform_int_distribution", scalar,
+			[](substrate::xoshiro256pp_t &rng, std::vector<uint64_t> &values)
+		{
+			std::uniform_int_distribution<uint64_t> distribution{0U, bound - 1U};
+			for (auto &value : values)
+				value = distribution(rng);
+		});
+
+		measureDistribution<double>("uniform_real_t", scalar, [](substrate::xoshiro256pp_t &rng, std::vector<double> &values)
+			{ substrate::uniform_real_t<double>{}.fill(rng, values); });
+		measureDistribution<double>("uniform_real_t x8", lanes, [](substrate::xoshiro256x8pp_t &rng, std::vector<double> &values)
+			{ substrate::uniform_real_t<double>{}.fill(rng, values); });
+		measureDistribution<double>("std::uniform_real_distribution", scalar,
+			[](substrate::xoshiro256pp_t &rng, std::vector<double> &values)
+		{
+			std::uniform_real_distribution<double> distribution{};
+			for (auto &value : values)
+				value = distribution(rng);
+		});
+
+		measureDistribution<double>("normal_t", scalar, [](substrate::xoshiro256pp_t &rng, std::vector<double> &values)
+			{ substrate::normal_t<double>{}.fill(rng, values); });
+		measureDistribution<double>("normal_t x8", lanes, [](substrate::xoshiro256x8pp_t &rng, std::vector<double> &values)
+			{ substrate::normal_t<double>{}.fill(rng, values); });
+		measureDistribution<double>("std::normal_distribution", scalar,
+			[](substrate::xoshiro256pp_t &rng, std::vector<double> &values)
+		{
+			std::normal_distribution<double> distribution{};
+			for (auto &value : values)
+				value = distribution(rng);
+		});
+
+		measureDistribution<double>("exponential_t", scalar, [](substrate::xoshiro256pp_t &rng, std::vector<double> &values)
+			{ substrate::exponential_t<double>{}.fill(rng, values); });
+		measureDistribution<double>("std::exponential_distribution", scalar,
+			[](substrate::xoshiro256pp_t &rng, std::vector<double> &values)
+		{
+			std::exponential_distribution<double> distribution{};
+			for (auto &value : values)
+				value = distribution(rng);
+		});
+	}
+
+	void prngBenchmarks()
+	{
+		constexpr std::array<uint32_t, 4> seed32{{0x12345678U, 0x9ABCDEF0U, 0x0FEDCBA9U, 0x87654321U}};
+		constexpr std::array<uint64_t, 4> seed64{{
+			UINT64_C(0x0123456789ABCDEF), UINT64_C(0xFEDCBA9876543210),
+			UINT64_C(0x0F1E2D3C4B5A6978), UINT64_C(0x8796A5B4C3D2E1F0)
+		}};
+		measurePRNG<substrate::splitmix64_t>("splitmix64", seed64[0]);
+		// Counter-based draws from one shared generator, which threaded passes run on every thread at once
+		const substrate::splitmix64_t counter{seed64[0]};
+		for (const auto size : benchmark::sizes())
+		{
+			const auto count{size / sizeof(uint64_t)};
+			benchmark::measure("splitmix64 at()", size, [&]()
+			{
+				uint64_t sum{};
+				for (size_t i{}; i < count; ++i)
+					sum ^= counter.at(i);
+				benchmark::doNotOptimise(sum);
+			});
+		}
+		measurePRNG<substrate::xoshiro128pp_t>("xoshiro128++", seed32);
+		measurePRNG<substrate::xoroshiro128pp_t>("xoroshiro128++", std::array<uint64_t, 2>{{seed64[0], seed64[1]}});
+		measurePRNG<substrate::xoshiro256pp_t>("xoshiro256++", seed64);
+		measurePRNG<substrate::xoshiro256ss_t>("xoshiro256**", seed64);
+		measureFill<substrate::xoshiro256x8pp_t>("xoshiro256x8++ fill", seed64);
+		measureFill<substrate::xoshiro256x8ss_t>("xoshiro256x8** fill", seed64);
+	}
+
+	const benchmark::registration_t registration{"prng", prngBenchmarks};
+	const benchmark::registration_t distributionRegistration{"distributions", distributionBenchmarks};
+} // namespace
+
+/* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
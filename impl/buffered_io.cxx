@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "substrate/advanced/buffered_io"
+
+namespace substrate
+{
+	namespace advanced
+	{
+#if __cplusplus < 201703L
+		constexpr size_t bufferedReader_t::defaultBufferSize;
+		constexpr size_t bufferedWriter_t::defaultBufferSize;
+#endif
+
+		bufferedReader_t::bufferedReader_t(const readable_t &source, const size_t bufferSize) noexcept :
+			_source{source}, _buffer{make_unique_nothrow<uint8_t []>(bufferSize)},
+			_bufferSize{_buffer ? bufferSize : 0U} { }
+
+		// Reads from the source until at least count bytes are buffered, returning false if the source fails
+		bool bufferedReader_t::fill(size_t count) const noexcept
+		{
+			count = std::min(count, _bufferSize);
+			if (_length - _offset >= count)
+				return true;
+			// Shuffle what's left down to the front so the rest of the buffer is free for the source
+			if (_offset)
+			{
+				std::memmove(_buffer.get(), _buffer.get() + _offset, _length - _offset);
+				_length -= _offset;
+				_offset = 0U;
+			}
+			while (_length < count)
+			{
+				const auto result{_source.read(_buffer.get() + _length, _bufferSize - _length, nullptr)};
+				if (result <= 0)
+				{
+					_eof = !result;
+					return !result;
+				}
+				_length += size_t(result);
+			}
+			_eof = false;
+			return true;
+		}
+
+		ssize_t bufferedReader_t::readBuffered(uint8_t *const bufferPtr, const size_t bufferLen) const noexcept
+		{
+			size_t copied{std::min(bufferLen, _length - _offset)};
+			if (copied)
+			{
+				std::memcpy(bufferPtr, _buffer.get() + _offset, copied);
+				_offset += copied;
+			}
+			if (copied == bufferLen)
+				return ssize_t(copied);
+
+			auto remaining{bufferLen - copied};
+			if (remaining < _bufferSize)
+			{
+				const bool filled{fill(remaining)};
+				const auto count{std::min(remaining, _length - _offset)};
+				if (count)
+				{
+					std::memcpy(bufferPtr + copied, _buffer.get() + _offset, count);
+					_offset += count;
+					copied += count;
+				}
+				return !filled && !copied ? -1 : ssize_t(copied);
+			}
+
+			// Big reads skip the buffer, which is now empty, and go straight into the caller's memory
+			while (remaining)
+			{
+				const auto result{_source.read(bufferPtr + copied, remaining, nullptr)};
+				if (result <= 0)
+				{
+					_eof = !result;
+					if (result < 0 && !copied)
+						return -1;
+					break;
+				}
+				copied += size_t(result);
+				remaining -= size_t(result);
+			}
+			return ssize_t(copied);
+		}
+
+		span<const uint8_t> bufferedReader_t::peek(const size_t count) const noexcept
+		{
+			SUBSTRATE_NOWARN_UNUSED(const auto filled) = fill(count);
+			return {_buffer.get() + _offset, std::min(count, _length - _offset)};
+		}
+
+		size_t bufferedReader_t::consume(size_t count) const noexcept
+		{
+			count = std::min(count, _length - _offset);
+			_offset += count;
+			return count;
+		}
+
+		bufferedWriter_t::bufferedWriter_t(const writeable_t &sink, const size_t bufferSize) noexcept :
+			_sink{sink}, _buffer{make_unique_nothrow<uint8_t []>(bufferSize)},
+			_bufferSize{_buffer ? bufferSize : 0U} { }
+
+		bufferedWriter_t::~bufferedWriter_t() noexcept
+			{ SUBSTRATE_NOWARN_UNUSED(const auto flushed) = flush(); }
+
+		bool bufferedWriter_t::flush() const noexcept
+		{
+			size_t written{};
+			while (written < _length)
+			{
+				const auto result{_sink.write(_buffer.get() + written, _length - written, nullptr)};
+				if (result <= 0)
+					break;
+				written += size_t(result);
+			}
+			if (written && written != _length)
+				std::memmove(_buffer.get(), _buffer.get() + written, _length - written);
+			_length -= written;
+			return !_length;
+		}
+
+		ssize_t bufferedWriter_t::writeBuffered(const uint8_t *const bufferPtr, const size_t bufferLen) const noexcept
+		{
+			if (!bufferLen)
+				return 0;
+			if (!flush())
+				return -1;
+			if (bufferLen < _bufferSize)
+			{
+				std::memcpy(_buffer.get(), bufferPtr, bufferLen);
+				_length = bufferLen;
+				return ssize_t(bufferLen);
+			}
+
+			size_t written{};
+			while (written < bufferLen)
+			{
+				const auto result{_sink.write(bufferPtr + written, bufferLen - written, nullptr)};
+				if (result <= 0)
+					return written ? ssize_t(written) : -1;
+				written += size_t(result);
+			}
+			return ssize_t(written);
+		}
+	}
+}
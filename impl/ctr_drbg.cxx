@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#	ifndef NOMINMAX
+#	define NOMINMAX
+#	endif
+#	ifndef WIN32_LEAN_AND_MEAN
+#	define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <windows.h>
+#	include <bcrypt.h>
+#	include <process.h>
+#	include <limits>
+#else
+#	include <pthread.h>
+#	include <unistd.h>
+#	if defined(__linux__)
+#		include <sys/random.h>
+#	elif defined(__APPLE__)
+#		include <sys/random.h>
+#	endif
+#endif
+
+#include "substrate/crypto/ctr_drbg"
+#include "substrate/internal/wipe"
+
+namespace substrate
+{
+	namespace crypto
+	{
+#if __cplusplus < 201703L
+		constexpr size_t ctrDrbg_t::bufferSize;
+		constexpr uint64_t ctrDrbg_t::defaultReseedBytes;
+		constexpr std::chrono::seconds ctrDrbg_t::defaultReseedInterval;
+		constexpr size_t ctrDrbg_t::keyLength;
+		constexpr size_t ctrDrbg_t::nonceLength;
+		constexpr size_t ctrDrbg_t::seedLength;
+#endif
+
+		namespace
+		{
+			std::atomic<int64_t> cachedPid{};
+
+#ifndef _WIN32
+			void forkedChild() noexcept { cachedPid = int64_t{getpid()}; }
+#endif
+
+			// getpid() is a full system call on current glibc, so keep the pid cached and refresh it in fork()ed children
+			int64_t processID() noexcept
+			{
+				static const bool registered{[]() noexcept
+				{
+#ifdef _WIN32
+					cachedPid = int64_t{_getpid()};
+#else
+					cachedPid = int64_t{getpid()};
+					pthread_atfork(nullptr, nullptr, forkedChild);
+#endif
+					return true;
+				}()};
+				static_cast<void>(registered);
+				return cachedPid.load(std::memory_order_relaxed);
+			}
+		} // namespace
+
+		ctrDrbg_t::ctrDrbg_t(const uint64_t reseedBytes, const clock_t::duration reseedInterval) noexcept :
+			_reseedBytes{reseedBytes}, _reseedInterval{reseedInterval} { reseed(); }
+
+		ctrDrbg_t::~ctrDrbg_t() noexcept { internal::wipe(_buffer.data(), _buffer.size()); }
+
+		void ctrDrbg_t::entropy(uint8_t *data, size_t len) noexcept
+		{
+#if defined(_WIN32)
+			// Straight from the OS generator, as std::random_device on older MinGW is a fixed sequence
+			while (len)
+			{
+				const auto count{static_cast<ULONG>(std::min<size_t>(len, std::numeric_limits<ULONG>::max()))};
+				if (!BCRYPT_SUCCESS(BCryptGenRandom(nullptr, data, count, BCRYPT_USE_SYSTEM_PREFERRED_RNG)))
+					std::abort();
+				data += count;
+				len -= count;
+			}
+#elif defined(__linux__)
+			while (len)
+			{
+				const auto result{getrandom(data, len, 0U)};
+				if (result < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					std::abort();
+				}
+				data += result;
+				len -= size_t(result);
+			}
+#else
+			// getentropy() hands out at most 256 bytes a call
+			while (len)
+			{
+				const auto count{std::min<size_t>(len, 256U)};
+				if (getentropy(data, count))
+					std::abort();
+				data += count;
+				len -= count;
+			}
+#endif
+		}
+
+		void ctrDrbg_t::rekey(const uint8_t *const seed) noexcept
+		{
+			_cipher.set_key(seed, keyLength);
+			std::array<uint8_t, nonceLength> nonce{{}};
+			std::memcpy(nonce.data(), seed + keyLength, nonce.size());
+			_cipher.set_iv(nonce);
+			internal::wipe(nonce.data(), nonce.size());
+		}
+
+		/*
+		 * Runs a buffer's worth of keystream and moves straight on to the key and nonce at its front, so the
+		 * key that made the output handed out from here is already gone. Every key is only ever used for one
+		 * buffer, which is why the counter can restart from 0 each time.
+		 */
+		void ctrDrbg_t::refill() noexcept
+		{
+			std::memset(_buffer.data(), 0, _buffer.size());
+			_cipher.crypt(_buffer, _buffer, 0U);
+			rekey(_buffer.data());
+			internal::wipe(_buffer.data(), seedLength);
+			_available = _buffer.size() - seedLength;
+			_sinceReseed += _available;
+		}
+
+		/*
+		 * The fresh entropy is XORed with keystream from the current key, which no output has come from yet,
+		 * so the new key is no weaker than either; that matters in a fork()ed child, which starts from its
+		 * parent's key.
+		 */
+		void ctrDrbg_t::reseed() noexcept
+		{
+			std::array<uint8_t, seedLength> seed{{}};
+			entropy(seed.data(), seed.size());
+			_cipher.crypt(seed, seed, 0U);
+			rekey(seed.data());
+			internal::wipe(seed.data(), seed.size());
+			internal::wipe(_buffer.data(), _buffer.size());
+			_available = 0U;
+			_sinceReseed = 0U;
+			_lastReseed = clock_t::now();
+			_pid = processID();
+			++_reseeds;
+		}
+
+		void ctrDrbg_t::fill(const span<uint8_t> &out) noexcept
+		{
+			if (_pid != processID())
+				reseed();
+
+			auto *dst{out.data()};
+			auto len{out.size()};
+			while (len)
+			{
+				if (!_available)
+				{
+					// The limits are only checked a buffer at a time to keep the clock off the per-call path
+					if (_sinceReseed >= _reseedBytes || clock_t::now() - _lastReseed >= _reseedInterval)
+						reseed();
+					refill();
+				}
+				const auto count{std::min(len, _available)};
+				auto *const src{_buffer.data() + (_buffer.size() - _available)};
+				std::memcpy(dst, src, count);
+				internal::wipe(src, count);
+				_available -= count;
+				dst += count;
+				len -= count;
+			}
+		}
+
+		ctrDrbg_t &ctrDrbg_t::thread_instance() noexcept
+		{
+			thread_local ctrDrbg_t instance{};
+			return instance;
+		}
+	} // namespace crypto
+} // namespace substrate
@@ -1,5 +1,530 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <vector>
+
 #include "substrate/hash"
+#include "substrate/thread_pool"
+#include "substrate/internal/cpu_features"
+
+#if defined(SUBSTRATE_ARCH_X86)
+#	include <immintrin.h>
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+#	include <arm_neon.h>
+#	if defined(_MSC_VER) && !defined(__clang__)
+#		include <intrin.h>
+#	else
+#		include <arm_acle.h>
+#	endif
+#endif
 
 #if __cplusplus < 201703L
 const std::array<const uint32_t, 256> substrate::crc32_t::crcTable;
+const std::array<const uint32_t, 256> substrate::crc32c_t::crcTable;
+#endif
+
+namespace substrate
+{
+	namespace internal
+	{
+		namespace
+		{
+			using sliceTable_t = std::array<std::array<uint32_t, 256>, 16>;
+
+			// Slicing-by-16 tables, where table N is the CRC of a byte followed by N zero bytes
+			sliceTable_t makeSliceTable(const std::array<const uint32_t, 256> &crcTable) noexcept
+			{
+				sliceTable_t table{};
+				for (size_t i{}; i < 256U; ++i)
+					table[0][i] = crcTable[i];
+				for (size_t slice{1}; slice < table.size(); ++slice)
+				{
+					for (size_t i{}; i < 256U; ++i)
+					{
+						const auto prev{table[slice - 1U][i]};
+						table[slice][i] = (prev >> 8U) ^ table[0][prev & 0xFFU];
+					}
+				}
+				return table;
+			}
+
+			const sliceTable_t &crc32Tables() noexcept
+			{
+				static const sliceTable_t table{makeSliceTable(crc32_t::crcTable)};
+				return table;
+			}
+
+			const sliceTable_t &crc32cTables() noexcept
+			{
+				static const sliceTable_t table{makeSliceTable(crc32c_t::crcTable)};
+				return table;
+			}
+
+			inline uint32_t readLE32(const uint8_t *const data) noexcept
+			{
+				return uint32_t(data[0]) | (uint32_t(data[1]) << 8U) |
+					(uint32_t(data[2]) << 16U) | (uint32_t(data[3]) << 24U);
+			}
+
+			inline uint32_t crcSliced(const sliceTable_t &table, uint32_t crc, const uint8_t *data, size_t dataLen) noexcept
+			{
+				while (dataLen >= 16U)
+				{
+					const uint32_t a{crc ^ readLE32(data)};
+					const uint32_t b{readLE32(data + 4)};
+					const uint32_t c{readLE32(data + 8)};
+					const uint32_t d{readLE32(data + 12)};
+					crc =
+						table[15][a & 0xFFU] ^ table[14][(a >> 8U) & 0xFFU] ^
+						table[13][(a >> 16U) & 0xFFU] ^ table[12][a >> 24U] ^
+						table[11][b & 0xFFU] ^ table[10][(b >> 8U) & 0xFFU] ^
+						table[9][(b >> 16U) & 0xFFU] ^ table[8][b >> 24U] ^
+						table[7][c & 0xFFU] ^ table[6][(c >> 8U) & 0xFFU] ^
+						table[5][(c >> 16U) & 0xFFU] ^ table[4][c >> 24U] ^
+						table[3][d & 0xFFU] ^ table[2][(d >> 8U) & 0xFFU] ^
+						table[1][(d >> 16U) & 0xFFU] ^ table[0][d >> 24U];
+					data += 16;
+					dataLen -= 16U;
+				}
+				while (dataLen--)
+					crc = table[0][(crc ^ *data++) & 0xFFU] ^ (crc >> 8U);
+				return crc;
+			}
+
+			uint32_t crc32Sliced(const uint32_t crc, const uint8_t *const data, const size_t dataLen) noexcept
+				{ return crcSliced(crc32Tables(), crc, data, dataLen); }
+			uint32_t crc32cSliced(const uint32_t crc, const uint8_t *const data, const size_t dataLen) noexcept
+				{ return crcSliced(crc32cTables(), crc, data, dataLen); }
+
+#if defined(SUBSTRATE_ARCH_X86)
+			/*
+			 * CRC32 by carry-less multiplication folding, after "Fast CRC Computation for Generic
+			 * Polynomials Using PCLMULQDQ Instruction" (Gopal et al, Intel, 2009). The constants are the
+			 * bit-reflected x^n mod P(x) folding multipliers and the Barrett reduction constants for the
+			 * 802.3 polynomial. Requires at least 64 bytes and consumes a multiple of 16.
+			 */
+			inline __m128i loadBlock(const uint8_t *const data) noexcept
+			{
+				__m128i block{};
+				std::memcpy(&block, data, sizeof(block));
+				return block;
+			}
+
+			SUBSTRATE_TARGET("pclmul") inline __m128i foldBlock(const __m128i acc, const __m128i next,
+				const __m128i constants) noexcept
+			{
+				const auto lo{_mm_clmulepi64_si128(acc, constants, 0x00)};
+				const auto hi{_mm_clmulepi64_si128(acc, constants, 0x11)};
+				return _mm_xor_si128(_mm_xor_si128(hi, next), lo);
+			}
+
+			SUBSTRATE_TARGET("sse4.1,pclmul") uint32_t crc32Fold(uint32_t crc, const uint8_t *data, size_t dataLen) noexcept
+			{
+				const auto k1k2{_mm_set_epi64x(0x01C6E41596, 0x0154442BD4)};
+				const auto k3k4{_mm_set_epi64x(0x00CCAA009E, 0x01751997D0)};
+				const auto k5k0{_mm_set_epi64x(0x0000000000, 0x0163CD6124)};
+				const auto poly{_mm_set_epi64x(0x01F7011641, 0x01DB710641)};
+				const auto mask32{_mm_setr_epi32(~0, 0, ~0, 0)};
+
+				auto x1{loadBlock(data)};
+				auto x2{loadBlock(data + 16)};
+				auto x3{loadBlock(data + 32)};
+				auto x4{loadBlock(data + 48)};
+				x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(int32_t(crc)));
+				data += 64;
+				dataLen -= 64U;
+
+				// Fold 4 lanes in parallel while we have 64 byte blocks to work with
+				while (dataLen >= 64U)
+				{
+					x1 = foldBlock(x1, loadBlock(data), k1k2);
+					x2 = foldBlock(x2, loadBlock(data + 16), k1k2);
+					x3 = foldBlock(x3, loadBlock(data + 32), k1k2);
+					x4 = foldBlock(x4, loadBlock(data + 48), k1k2);
+					data += 64;
+					dataLen -= 64U;
+				}
+
+				// Fold the 4 lanes down into one
+				x1 = foldBlock(x1, x2, k3k4);
+				x1 = foldBlock(x1, x3, k3k4);
+				x1 = foldBlock(x1, x4, k3k4);
+
+				// Then fold in any remaining 16 byte blocks
+				while (dataLen >= 16U)
+				{
+					x1 = foldBlock(x1, loadBlock(data), k3k4);
+					data += 16;
+					dataLen -= 16U;
+				}
+
+				// Reduce 128 bits to 64
+				x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+				x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+				x2 = _mm_srli_si128(x1, 4);
+				x1 = _mm_and_si128(x1, mask32);
+				x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+				x1 = _mm_xor_si128(x1, x2);
+
+				// Barrett reduce down to the final 32 bits
+				x2 = _mm_and_si128(x1, mask32);
+				x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+				x2 = _mm_and_si128(x2, mask32);
+				x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+				x1 = _mm_xor_si128(x1, x2);
+				return uint32_t(_mm_extract_epi32(x1, 1));
+			}
+
+			SUBSTRATE_TARGET("sse4.1,pclmul") uint32_t crc32PCLMUL(uint32_t crc, const uint8_t *data, size_t dataLen) noexcept
+			{
+				if (dataLen >= 64U)
+				{
+					const auto foldLen{dataLen & ~size_t{15U}};
+					crc = crc32Fold(crc, data, foldLen);
+					data += foldLen;
+					dataLen -= foldLen;
+				}
+				return crc32Sliced(crc, data, dataLen);
+			}
+
+			SUBSTRATE_TARGET("sse4.2") uint32_t crc32cSSE42(uint32_t crc, const uint8_t *data, size_t dataLen) noexcept
+			{
+#	if defined(__x86_64__) || defined(_M_X64)
+				uint64_t crc64{crc};
+				while (dataLen >= 8U)
+				{
+					uint64_t value{};
+					std::memcpy(&value, data, sizeof(value));
+					crc64 = _mm_crc32_u64(crc64, value);
+					data += 8;
+					dataLen -= 8U;
+				}
+				crc = uint32_t(crc64);
+#	endif
+				while (dataLen >= 4U)
+				{
+					uint32_t value{};
+					std::memcpy(&value, data, sizeof(value));
+					crc = _mm_crc32_u32(crc, value);
+					data += 4;
+					dataLen -= 4U;
+				}
+				while (dataLen--)
+					crc = _mm_crc32_u8(crc, *data++);
+				return crc;
+			}
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+			// ARMv8's CRC32 extension implements both polynomials directly, so no folding is needed
+			SUBSTRATE_TARGET("+crc") uint32_t crc32ARMv8(uint32_t crc, const uint8_t *data, size_t dataLen) noexcept
+			{
+				while (dataLen >= 8U)
+				{
+					uint64_t value{};
+					std::memcpy(&value, data, sizeof(value));
+					crc = __crc32d(crc, value);
+					data += 8;
+					dataLen -= 8U;
+				}
+				while (dataLen--)
+					crc = __crc32b(crc, *data++);
+				return crc;
+			}
+
+			SUBSTRATE_TARGET("+crc") uint32_t crc32cARMv8(uint32_t crc, const uint8_t *data, size_t dataLen) noexcept
+			{
+				while (dataLen >= 8U)
+				{
+					uint64_t value{};
+					std::memcpy(&value, data, sizeof(value));
+					crc = __crc32cd(crc, value);
+					data += 8;
+					dataLen -= 8U;
+				}
+				while (dataLen--)
+					crc = __crc32cb(crc, *data++);
+				return crc;
+			}
+#endif
+
+			/*
+			 * CRC combination, after zlib's crc32_combine(): appending lenB bytes to A multiplies A's
+			 * polynomial by x^(8 * lenB) modulo P(x), which we do by square-and-multiply over a table of
+			 * x^(2^n) mod P(x). All polynomials here are in the bit-reflected representation.
+			 */
+			uint32_t multModP(const uint32_t poly, const uint32_t a, uint32_t b) noexcept
+			{
+				uint32_t product{};
+				for (uint32_t bit{UINT32_C(1) << 31U}; bit; bit >>= 1U)
+				{
+					if (a & bit)
+						product ^= b;
+					b = (b & 1U) ? (b >> 1U) ^ poly : b >> 1U;
+				}
+				return product;
+			}
+
+			struct crcCombiner_t final
+			{
+			private:
+				uint32_t poly;
+				// x^(2^(n + 3)) for every bit of a 64-bit byte count; these don't repeat with a short period for
+				// every polynomial, so there's one entry per bit rather than a wrapped-around table
+				std::array<uint32_t, 64> x2n{};
+
+			public:
+				crcCombiner_t(const uint32_t polynomial) noexcept : poly{polynomial}
+				{
+					// x^8, then each subsequent entry is the square of the one prior
+					uint32_t value{UINT32_C(1) << 23U};
+					for (auto &entry : x2n)
+					{
+						entry = value;
+						value = multModP(poly, value, value);
+					}
+				}
+
+				uint32_t operator ()(const uint32_t crcA, const uint32_t crcB, uint64_t lenB) const noexcept
+				{
+					// x^(8 * lenB) mod P(x), from one table entry per set bit in lenB
+					uint32_t shift{UINT32_C(1) << 31U};
+					for (size_t n{}; lenB; lenB >>= 1U, ++n)
+					{
+						if (lenB & 1U)
+							shift = multModP(poly, x2n[n], shift);
+					}
+					return multModP(poly, shift, crcA) ^ crcB;
+				}
+			};
+
+			/*
+			 * Byte summing for sysv_checksum(). The SAD instructions sum 8 bytes into each 64-bit lane per
+			 * step, so the vector accumulators can't overflow; the result is only cut down to 32 bits at the end.
+			 */
+			uint32_t byteSumScalar(const uint8_t *const data, const size_t dataLen) noexcept
+			{
+				uint32_t sum{};
+				for (size_t i{}; i < dataLen; ++i)
+					sum += data[i];
+				return sum;
+			}
+
+#if defined(SUBSTRATE_ARCH_X86)
+			// Only the low 32 bits of the total are wanted, so this adds the low halves of the two 64-bit lanes,
+			// which (unlike _mm_cvtsi128_si64()) works on 32-bit x86 as well
+			SUBSTRATE_TARGET("sse2") inline uint32_t sumLanes(const __m128i sum) noexcept
+				{ return uint32_t(_mm_cvtsi128_si32(sum)) + uint32_t(_mm_cvtsi128_si32(_mm_srli_si128(sum, 8))); }
+
+			SUBSTRATE_TARGET("sse2") uint32_t byteSumSSE2(const uint8_t *data, size_t dataLen) noexcept
+			{
+				const auto zero{_mm_setzero_si128()};
+				auto sumA{_mm_setzero_si128()};
+				auto sumB{_mm_setzero_si128()};
+				for (; dataLen >= 32U; dataLen -= 32U, data += 32)
+				{
+					sumA = _mm_add_epi64(sumA, _mm_sad_epu8(loadBlock(data), zero));
+					sumB = _mm_add_epi64(sumB, _mm_sad_epu8(loadBlock(data + 16), zero));
+				}
+				return sumLanes(_mm_add_epi64(sumA, sumB)) + byteSumScalar(data, dataLen);
+			}
+
+			SUBSTRATE_TARGET("avx2") uint32_t byteSumAVX2(const uint8_t *data, size_t dataLen) noexcept
+			{
+				const auto zero{_mm256_setzero_si256()};
+				auto sumA{_mm256_setzero_si256()};
+				auto sumB{_mm256_setzero_si256()};
+				for (; dataLen >= 64U; dataLen -= 64U, data += 64)
+				{
+					__m256i blockA{};
+					__m256i blockB{};
+					std::memcpy(&blockA, data, sizeof(blockA));
+					std::memcpy(&blockB, data + 32, sizeof(blockB));
+					sumA = _mm256_add_epi64(sumA, _mm256_sad_epu8(blockA, zero));
+					sumB = _mm256_add_epi64(sumB, _mm256_sad_epu8(blockB, zero));
+				}
+				const auto sum256{_mm256_add_epi64(sumA, sumB)};
+				const auto sum{_mm_add_epi64(_mm256_castsi256_si128(sum256), _mm256_extracti128_si256(sum256, 1))};
+				return sumLanes(sum) + byteSumSSE2(data, dataLen);
+			}
+
+			SUBSTRATE_TARGET("avx512f,avx512bw") uint32_t byteSumAVX512(const uint8_t *data, size_t dataLen) noexcept
+			{
+				const auto zero{_mm512_setzero_si512()};
+				auto sumA{_mm512_setzero_si512()};
+				auto sumB{_mm512_setzero_si512()};
+				for (; dataLen >= 128U; dataLen -= 128U, data += 128)
+				{
+					sumA = _mm512_add_epi64(sumA, _mm512_sad_epu8(_mm512_loadu_si512(data), zero));
+					sumB = _mm512_add_epi64(sumB, _mm512_sad_epu8(_mm512_loadu_si512(data + 64), zero));
+				}
+				const auto sum{_mm512_add_epi64(sumA, sumB)};
+				std::array<uint64_t, 8> lanes{};
+				std::memcpy(lanes.data(), &sum, sizeof(sum));
+				uint64_t total{};
+				for (const auto &lane : lanes)
+					total += lane;
+				return uint32_t(total) + byteSumAVX2(data, dataLen);
+			}
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+			uint32_t byteSumNEON(const uint8_t *data, size_t dataLen) noexcept
+			{
+				auto total{vdupq_n_u64(0U)};
+				while (dataLen >= 32U)
+				{
+					// UADALP pairwise-accumulates bytes into 16-bit lanes, which hold at most 128 rounds of 2 * 255
+					auto sumA{vdupq_n_u16(0U)};
+					auto sumB{vdupq_n_u16(0U)};
+					for (size_t round{}; round < 128U && dataLen >= 32U; ++round, dataLen -= 32U, data += 32)
+					{
+						sumA = vpadalq_u8(sumA, vld1q_u8(data));
+						sumB = vpadalq_u8(sumB, vld1q_u8(data + 16));
+					}
+					total = vpadalq_u32(total, vpaddlq_u16(sumA));
+					total = vpadalq_u32(total, vpaddlq_u16(sumB));
+				}
+				return uint32_t(vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1)) + byteSumScalar(data, dataLen);
+			}
 #endif
+
+			struct byteSumJob_t final
+			{
+				const uint8_t *data;
+				size_t length;
+				uint32_t sum;
+			};
+
+			bool byteSumWorker(byteSumJob_t *const job) noexcept
+			{
+				job->sum = byteSum(job->data, job->length);
+				return true;
+			}
+
+			// Throws if the threads or the job list can't be had
+			uint32_t byteSumParallel(const uint8_t *const bytes, const size_t len, const size_t minimumChunk)
+			{
+				threadPool_t<bool (byteSumJob_t *)> pool{byteSumWorker};
+				// Give each processor a few chunks so a slow worker doesn't hold everything up
+				const auto chunks{std::min(pool.numProcessors() * 4U, len / minimumChunk)};
+				const auto chunkLength{(len + chunks - 1U) / chunks};
+				std::vector<byteSumJob_t> jobs{};
+				jobs.reserve(chunks);
+				for (size_t offset{}; offset < len; offset += chunkLength)
+					jobs.push_back({bytes + offset, std::min(chunkLength, len - offset), 0U});
+				for (auto &job : jobs)
+					SUBSTRATE_NOWARN_UNUSED(const auto result) = pool.queue(&job);
+				SUBSTRATE_NOWARN_UNUSED(const auto result) = pool.finish();
+
+				uint32_t sum{};
+				for (const auto &job : jobs)
+					sum += job.sum;
+				return sum;
+			}
+		} // namespace
+
+		kernels_t<byteSumKernel_t> byteSumKernels() noexcept
+		{
+			SUBSTRATE_NOWARN_UNUSED(const auto &features){cpuFeatures()};
+			kernels_t<byteSumKernel_t> kernels{};
+#if defined(SUBSTRATE_ARCH_X86)
+			if (features.avx512)
+				kernels.add("AVX-512", byteSumAVX512);
+			if (features.avx2)
+				kernels.add("AVX2", byteSumAVX2);
+#	if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+			kernels.add("SSE2", byteSumSSE2);
+#	endif
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+			kernels.add("NEON", byteSumNEON);
+#endif
+			kernels.add("scalar", byteSumScalar);
+			return kernels;
+		}
+
+		kernels_t<crcKernel_t> crc32Kernels() noexcept
+		{
+			SUBSTRATE_NOWARN_UNUSED(const auto &features){cpuFeatures()};
+			kernels_t<crcKernel_t> kernels{};
+#if defined(SUBSTRATE_ARCH_X86)
+			if (features.pclmul && features.sse42)
+				kernels.add("PCLMUL", crc32PCLMUL);
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+			if (features.crc32)
+				kernels.add("ARMv8", crc32ARMv8);
+#endif
+			kernels.add("slicing-by-16", crc32Sliced);
+			return kernels;
+		}
+
+		kernels_t<crcKernel_t> crc32cKernels() noexcept
+		{
+			SUBSTRATE_NOWARN_UNUSED(const auto &features){cpuFeatures()};
+			kernels_t<crcKernel_t> kernels{};
+#if defined(SUBSTRATE_ARCH_X86)
+			if (features.sse42)
+				kernels.add("SSE4.2", crc32cSSE42);
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+			if (features.crc32)
+				kernels.add("ARMv8", crc32cARMv8);
+#endif
+			kernels.add("slicing-by-16", crc32cSliced);
+			return kernels;
+		}
+
+		uint32_t byteSum(const uint8_t *const data, const size_t dataLen) noexcept
+		{
+			static const auto kernel{byteSumKernels().front().function};
+			if (!data || !dataLen)
+				return 0U;
+			return kernel(data, dataLen);
+		}
+
+		uint32_t crc32Update(const uint32_t crc, const uint8_t *const data, const size_t dataLen) noexcept
+		{
+			static const auto kernel{crc32Kernels().front().function};
+			if (!data || !dataLen)
+				return crc;
+			return kernel(crc, data, dataLen);
+		}
+
+		uint32_t crc32cUpdate(const uint32_t crc, const uint8_t *const data, const size_t dataLen) noexcept
+		{
+			static const auto kernel{crc32cKernels().front().function};
+			if (!data || !dataLen)
+				return crc;
+			return kernel(crc, data, dataLen);
+		}
+	} // namespace internal
+
+	uint32_t crc32_combine(const uint32_t crcA, const uint32_t crcB, const uint64_t lenB) noexcept
+	{
+		static const internal::crcCombiner_t combiner{0xEDB88320U};
+		return combiner(crcA, crcB, lenB);
+	}
+
+	uint32_t crc32c_combine(const uint32_t crcA, const uint32_t crcB, const uint64_t lenB) noexcept
+	{
+		static const internal::crcCombiner_t combiner{0x82F63B78U};
+		return combiner(crcA, crcB, lenB);
+	}
+
+	uint16_t sysv_checksum_parallel(const uint8_t *const bytes, const size_t len) noexcept
+	{
+		// Below this it costs more to spin the workers up than to just sum the data
+		constexpr size_t minimumChunk{1U << 20U};
+		if (!bytes)
+			return {};
+		if (len < minimumChunk * 2U)
+			return sysv_checksum(bytes, len);
+
+		try
+			{ return internal::sysvFold(internal::byteSumParallel(bytes, len, minimumChunk)); }
+		catch (const std::exception &)
+		{
+			// Out of threads or memory, so sum it all on this thread instead
+			return sysv_checksum(bytes, len);
+		}
+	}
+} // namespace substrate
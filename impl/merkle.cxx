@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "substrate/crypto/merkle"
+#include "substrate/thread_pool"
+
+namespace substrate
+{
+	namespace crypto
+	{
+		namespace
+		{
+			using digest_t = merkle_t::digest_t;
+
+			constexpr uint8_t leafPrefix{0x00U};
+			constexpr uint8_t nodePrefix{0x01U};
+			constexpr size_t nodeLength{1U + sizeof(digest_t) * 2U};
+			// Internal nodes are handed to sha256_many this many at a time to bound the scratch space
+			constexpr size_t nodeBatch{256U};
+			// Below this many bytes of leaves it costs more to spin the workers up than to hash them inline
+			constexpr size_t minimumParallel{2U << 20U};
+
+			struct leafJob_t final
+			{
+				const uint8_t *data;
+				size_t length;
+				size_t chunkSize;
+				const size_t *chunks;
+				size_t count;
+				digest_t *leaves;
+			};
+
+			bool leafWorker(leafJob_t *const job) noexcept
+			{
+				for (size_t i{}; i < job->count; ++i)
+				{
+					const auto chunk{job->chunks[i]};
+					const auto offset{chunk * job->chunkSize};
+					job->leaves[chunk] = merkle_t::hash_leaf({job->data + offset,
+						std::min(job->chunkSize, job->length - offset)});
+				}
+				return true;
+			}
+
+			// Recomputes the listed nodes of `level` from the level below, which has `below.size()` nodes
+			void updateNodes(const std::vector<digest_t> &below, std::vector<digest_t> &level,
+				const std::vector<size_t> &nodes)
+			{
+				std::vector<uint8_t> buffer(nodeBatch * nodeLength);
+				std::array<span<const uint8_t>, nodeBatch> messages{};
+				std::array<size_t, nodeBatch> targets{};
+				std::array<digest_t, nodeBatch> digests{};
+				size_t pending{};
+
+				const auto flush{[&]()
+				{
+					sha256_many({messages.data(), pending}, {digests.data(), pending});
+					for (size_t i{}; i < pending; ++i)
+						level[targets[i]] = digests[i];
+					pending = 0U;
+				}};
+
+				for (const auto node : nodes)
+				{
+					const auto left{node * 2U};
+					// A node without a partner is carried up as-is
+					if (left + 1U == below.size())
+					{
+						level[node] = below[left];
+						continue;
+					}
+					auto *const message{buffer.data() + pending * nodeLength};
+					message[0] = nodePrefix;
+					std::memcpy(message + 1U, below[left].data(), sizeof(digest_t));
+					std::memcpy(message + 1U + sizeof(digest_t), below[left + 1U].data(), sizeof(digest_t));
+					messages[pending] = {message, nodeLength};
+					targets[pending++] = node;
+					if (pending == nodeBatch)
+						flush();
+				}
+				if (pending)
+					flush();
+			}
+		} // namespace
+
+		merkle_t::merkle_t(const size_t chunkSize) noexcept : _chunkSize{chunkSize}
+		{
+			if (!_chunkSize)
+				std::abort();
+		}
+
+		digest_t merkle_t::hash_leaf(const span<const uint8_t> &chunk) noexcept
+		{
+			sha256_t hasher{};
+			hasher.update(&leafPrefix, 1U);
+			hasher.update(chunk);
+			return hasher.finalize();
+		}
+
+		digest_t merkle_t::hash_node(const digest_t &left, const digest_t &right) noexcept
+		{
+			sha256_t hasher{};
+			hasher.update(&nodePrefix, 1U);
+			hasher.update(left.data(), left.size());
+			hasher.update(right.data(), right.size());
+			return hasher.finalize();
+		}
+
+		digest_t merkle_t::root() const noexcept
+		{
+			if (_levels.empty())
+				return sha256_t{}.finalize();
+			return _levels.back().front();
+		}
+
+		void merkle_t::update_leaves(const span<const uint8_t> &data, const std::vector<size_t> &chunks)
+		{
+			auto &leaves{_levels.front()};
+			if (chunks.size() < 2U || chunks.size() * _chunkSize < minimumParallel)
+			{
+				leafJob_t job{data.data(), data.size(), _chunkSize, chunks.data(), chunks.size(), leaves.data()};
+				leafWorker(&job);
+				return;
+			}
+
+			threadPool_t<bool (leafJob_t *)> pool{leafWorker};
+			// Give each processor a few runs of chunks so a slow worker doesn't hold everything up
+			const auto jobCount{std::min(pool.numProcessors() * 4U, chunks.size())};
+			const auto jobLength{(chunks.size() + jobCount - 1U) / jobCount};
+			std::vector<leafJob_t> jobs{};
+			jobs.reserve(jobCount);
+			for (size_t offset{}; offset < chunks.size(); offset += jobLength)
+				jobs.push_back({data.data(), data.size(), _chunkSize, chunks.data() + offset,
+					std::min(jobLength, chunks.size() - offset), leaves.data()});
+			for (auto &job : jobs)
+				SUBSTRATE_NOWARN_UNUSED(const auto result) = pool.queue(&job);
+			SUBSTRATE_NOWARN_UNUSED(const auto result) = pool.finish();
+		}
+
+		digest_t merkle_t::hash(const span<const uint8_t> &data)
+		{
+			_levels.clear();
+			_length = 0U;
+			return rehash(data, {});
+		}
+
+		digest_t merkle_t::rehash(const span<const uint8_t> &data, const span<const size_t> &changedChunks)
+		{
+			const auto count{(data.size() + _chunkSize - 1U) / _chunkSize};
+			if (!count)
+			{
+				_levels.clear();
+				_length = 0U;
+				return root();
+			}
+
+			std::vector<size_t> oldSizes{};
+			oldSizes.reserve(_levels.size());
+			for (const auto &level : _levels)
+				oldSizes.push_back(level.size());
+
+			/*
+			 * At every level, the nodes from `tail` onwards are rebuilt wholesale and `dirty` lists the ones
+			 * before it that changed. If the length moved, everything from the chunk holding the shorter of the
+			 * two ends on is part of the tail, and a level growing or shrinking never changes a node ahead of
+			 * its tail.
+			 */
+			auto tail{_length == data.size() ? count : std::min(_length, data.size()) / _chunkSize};
+			std::vector<size_t> dirty{};
+			for (const auto chunk : changedChunks)
+			{
+				if (chunk < tail)
+					dirty.push_back(chunk);
+			}
+			std::sort(dirty.begin(), dirty.end());
+			dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+			if (_levels.empty())
+				_levels.emplace_back();
+			_levels.front().resize(count);
+			std::vector<size_t> nodes{dirty};
+			for (size_t chunk{tail}; chunk < count; ++chunk)
+				nodes.push_back(chunk);
+			update_leaves(data, nodes);
+
+			size_t depth{};
+			while (_levels[depth].size() > 1U)
+			{
+				const auto size{(_levels[depth].size() + 1U) / 2U};
+				const auto oldSize{depth + 1U < oldSizes.size() ? oldSizes[depth + 1U] : 0U};
+				tail = std::min(tail / 2U, oldSize);
+
+				for (auto &node : dirty)
+					node /= 2U;
+				dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+				dirty.erase(std::lower_bound(dirty.begin(), dirty.end(), tail), dirty.end());
+
+				nodes = dirty;
+				for (size_t node{tail}; node < size; ++node)
+					nodes.push_back(node);
+
+				if (depth + 1U == _levels.size())
+					_levels.emplace_back();
+				_levels[depth + 1U].resize(size);
+				updateNodes(_levels[depth], _levels[depth + 1U], nodes);
+				++depth;
+			}
+			_levels.resize(depth + 1U);
+			_length = data.size();
+			return root();
+		}
+	} // namespace crypto
+} // namespace substrate
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include "substrate/mmap"
+#include "substrate/thread_pool"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#	include <intrin.h>
+#endif
+
+namespace substrate
+{
+	namespace internal
+	{
+		namespace
+		{
+			// How much each populate() job covers, which is also how often progress is reported
+			constexpr std::size_t populateChunk{16U * 1024U * 1024U};
+
+			struct populateState_t final
+			{
+				populateMode_t mode;
+				std::size_t total;
+				const populateProgress_t &progress;
+				std::mutex progressMutex{};
+				std::size_t done{};
+				std::atomic<bool> failed{false};
+
+				populateState_t(const populateMode_t populateMode, const std::size_t length,
+					const populateProgress_t &progressFn) noexcept :
+					mode{populateMode}, total{length}, progress{progressFn} { }
+			};
+
+			struct populateJob_t final
+			{
+				populateState_t *state;
+				uint8_t *begin;
+				std::size_t length;
+			};
+
+			std::size_t systemPageSize() noexcept
+			{
+#ifdef _WIN32
+				SYSTEM_INFO info{};
+				GetSystemInfo(&info);
+				return info.dwPageSize;
+#else
+				return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+			}
+
+			// Write-faults the page holding byte by swapping the byte for itself, atomically so that a store
+			// racing us from another thread or process can't be lost (which writing back a read value could do)
+			void touchForWrite(uint8_t *const byte) noexcept
+			{
+#if defined(_MSC_VER) && !defined(__clang__)
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				auto *const value{reinterpret_cast<volatile char *>(byte)};
+				char expected{*value};
+				for (char prior{}; (prior = _InterlockedCompareExchange8(value, expected, expected)) != expected; )
+					expected = prior;
+#else
+				uint8_t expected{__atomic_load_n(byte, __ATOMIC_RELAXED)};
+				while (!__atomic_compare_exchange_n(byte, &expected, expected, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+					continue;
+#endif
+			}
+
+			void touchPages(uint8_t *const begin, const std::size_t length, const populateMode_t mode) noexcept
+			{
+				static const auto pageSize{systemPageSize()};
+				for (std::size_t offset{}; offset < length; offset += pageSize)
+				{
+					// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+					uint8_t *const byte{begin + offset};
+					if (mode == populateMode_t::write)
+						touchForWrite(byte);
+					else
+						SUBSTRATE_NOWARN_UNUSED(const uint8_t value) = *static_cast<volatile uint8_t *>(byte);
+				}
+			}
+
+#ifdef MADV_POPULATE_READ
+			/*
+			 * Whether the kernel knows MADV_POPULATE_* (Linux 5.14+), found out once on a scratch page so an
+			 * EINVAL from a real mapping (one the advice doesn't apply to) isn't taken to mean it doesn't
+			 */
+			bool havePopulateAdvice() noexcept
+			{
+				static const bool supported{[]() noexcept
+				{
+					const mmap_t page{-1, systemPageSize(), PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS};
+					return page.valid() && page.advise(MADV_POPULATE_READ);
+				}()};
+				return supported;
+			}
+#endif
+
+			bool populateRange(uint8_t *const begin, const std::size_t length, const populateMode_t mode) noexcept
+			{
+#ifdef MADV_POPULATE_READ
+				if (havePopulateAdvice())
+				{
+					const auto advice{mode == populateMode_t::write ? MADV_POPULATE_WRITE : MADV_POPULATE_READ};
+					int result{};
+					do
+						result = ::madvise(begin, length, advice);
+					while (result == -1 && (errno == EINTR || errno == EAGAIN));
+					if (!result)
+						return true;
+					// EINVAL on a read means the advice doesn't apply to this kind of mapping (VM_IO or VM_PFNMAP),
+					// which touching still works for. For a write it can as well mean the mapping isn't writable,
+					// which touching would turn into a signal, so like any other failure (such as pages past the
+					// end of the file) that's reported rather than touched through
+					if (errno != EINVAL || mode == populateMode_t::write)
+						return false;
+				}
+#endif
+				touchPages(begin, length, mode);
+				return true;
+			}
+
+			bool populateWorker(populateJob_t *const job) noexcept
+			{
+				auto &state{*job->state};
+				if (state.failed || !populateRange(job->begin, job->length, state.mode))
+				{
+					state.failed = true;
+					return false;
+				}
+				std::lock_guard<std::mutex> lock{state.progressMutex};
+				state.done += job->length;
+				if (state.progress)
+					state.progress(state.done, state.total);
+				return true;
+			}
+
+			// Throws if the threads or the job list can't be had, which is always before any work is done
+			bool populateParallel(populateState_t &state, uint8_t *const bytes, const std::size_t length)
+			{
+				std::vector<populateJob_t> jobs{};
+				jobs.reserve((length + populateChunk - 1U) / populateChunk);
+				for (std::size_t offset{}; offset < length; offset += populateChunk)
+					// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+					jobs.push_back({&state, bytes + offset, std::min(populateChunk, length - offset)});
+
+				threadPool_t<bool (populateJob_t *)> pool{populateWorker};
+				for (auto &job : jobs)
+					SUBSTRATE_NOWARN_UNUSED(const auto result) = pool.queue(&job);
+				SUBSTRATE_NOWARN_UNUSED(const auto result) = pool.finish();
+				return !state.failed;
+			}
+		} // namespace
+
+		bool populate(void *const address, const std::size_t length, const populateMode_t mode,
+			const populateProgress_t &progress) noexcept
+		{
+			if (!address)
+				return false;
+			populateState_t state{mode, length, progress};
+			auto *const bytes{static_cast<uint8_t *>(address)};
+			if (length > populateChunk)
+			{
+				try
+					{ return populateParallel(state, bytes, length); }
+				catch (const std::exception &)
+				{
+					// Out of threads or memory, so do it all on this thread instead
+				}
+			}
+
+			for (std::size_t offset{}; offset < length; offset += populateChunk)
+			{
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+				populateJob_t job{&state, bytes + offset, std::min(populateChunk, length - offset)};
+				if (!populateWorker(&job))
+					return false;
+			}
+			return true;
+		}
+
+#ifdef __linux__
+		namespace
+		{
+			// Parses a "Name:   1234 kB" statistics line from smaps into bytes, if it's the one asked for
+			bool parseSize(const char *const line, const char *const name, std::size_t &bytes) noexcept
+			{
+				const auto nameLength{std::strlen(name)};
+				if (std::strncmp(line, name, nameLength) != 0)
+					return false;
+				unsigned long long kilobytes{};
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic,cert-err34-c)
+				if (std::sscanf(line + nameLength, " %llu kB", &kilobytes) != 1)
+					return false;
+				bytes = static_cast<std::size_t>(kilobytes * 1024U);
+				return true;
+			}
+		} // namespace
+
+		mappingPages_t mappingPages(const void *const address, const std::size_t length) noexcept
+		{
+			mappingPages_t pages{0U, 0U};
+			if (!address || !length)
+				return pages;
+			std::FILE *const smaps{std::fopen("/proc/self/smaps", "r")};
+			if (!smaps)
+				return pages;
+
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			const auto begin{reinterpret_cast<std::uintptr_t>(address)};
+			const auto end{begin + length};
+			std::array<char, 256> line{};
+			bool lineStart{true};
+			bool inRange{false};
+			while (std::fgets(line.data(), static_cast<int>(line.size()), smaps))
+			{
+				// Long lines (mappings of files with long paths) come in several pieces; only look at the first
+				const bool wasLineStart{lineStart};
+				lineStart = std::strchr(line.data(), '\n') != nullptr;
+				if (!wasLineStart)
+					continue;
+
+				// Each mapping starts with a line giving its address range, which its statistics lines follow
+				unsigned long long first{};
+				unsigned long long last{};
+				std::size_t bytes{};
+				// NOLINTNEXTLINE(cert-err34-c)
+				if (std::sscanf(line.data(), "%llx-%llx ", &first, &last) == 2)
+					inRange = first < end && last > begin;
+				else if (!inRange)
+					continue;
+				else if (parseSize(line.data(), "KernelPageSize:", bytes))
+					pages.pageSize = std::max(pages.pageSize, bytes);
+				else if (parseSize(line.data(), "AnonHugePages:", bytes) ||
+					parseSize(line.data(), "ShmemPmdMapped:", bytes) ||
+					parseSize(line.data(), "FilePmdMapped:", bytes))
+					pages.transparentHugeBytes += bytes;
+			}
+			std::fclose(smaps);
+			return pages;
+		}
+#endif
+	} // namespace internal
+} // namespace substrate
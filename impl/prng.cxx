@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "substrate/prng"
+#include "substrate/internal/cpu_features"
+
+namespace substrate
+{
+	namespace internal
+	{
+		namespace
+		{
+			constexpr size_t lanes{8U};
+			using fillKernel_t = void (*)(std::array<uint64_t, 32> &, uint8_t *, size_t) noexcept;
+
+#if defined(__GNUC__) && !defined(__clang__)
+			// Vector word types only ever pass between always-inlined helpers so the ABI doesn't matter
+#	pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+			/*
+			 * One xoshiro256 step written over a generic word type, so the same code serves a single lane
+			 * (word_t = uint64_t) and the SIMD kernels, where word_t is a compiler vector holding the same
+			 * state word of several lanes. The multiplies of ** are spelt as shifts and adds as there is no
+			 * 64-bit vector multiply short of AVX-512.
+			 */
+			template<xoshiroScrambler_t scrambler, typename word_t> SUBSTRATE_ALWAYS_INLINE word_t
+				xoshiroStep(std::array<word_t, 4> &s) noexcept
+			{
+				const auto rotl{[](const word_t value, const unsigned bits) noexcept -> word_t
+					{ return (value << bits) | (value >> (64U - bits)); }};
+
+				word_t result{};
+				if (scrambler == xoshiroScrambler_t::plus)
+					result = s[0] + s[3];
+				else if (scrambler == xoshiroScrambler_t::plusPlus)
+					result = rotl(s[0] + s[3], 23U) + s[0];
+				else
+				{
+					const word_t times5{s[1] + (s[1] << 2U)};
+					const auto rotated{rotl(times5, 7U)};
+					result = rotated + (rotated << 3U);
+				}
+
+				const word_t t{s[1] << 17U};
+				s[2] ^= s[0];
+				s[3] ^= s[1];
+				s[1] ^= s[2];
+				s[0] ^= s[3];
+				s[2] ^= t;
+				s[3] = rotl(s[3], 45U);
+				return result;
+			}
+
+			/*
+			 * Runs the 8 lanes as 8 / width groups of width-wide vectors. Keeping every group in flight at
+			 * once gives the core independent work to overlap, even for the plain scalar instantiation.
+			 */
+			template<xoshiroScrambler_t scrambler, typename word_t> SUBSTRATE_ALWAYS_INLINE void
+				fillLanes(std::array<uint64_t, 32> &state, uint8_t *const out, const size_t blocks) noexcept
+			{
+				constexpr size_t width{sizeof(word_t) / sizeof(uint64_t)};
+				constexpr size_t groups{lanes / width};
+				std::array<std::array<word_t, 4>, groups> lanesState{};
+				for (size_t group{}; group < groups; ++group)
+				{
+					for (size_t word{}; word < 4U; ++word)
+						std::memcpy(&lanesState[group][word], &state[(word * lanes) + (group * width)], sizeof(word_t));
+				}
+
+				for (size_t block{}; block < blocks; ++block)
+				{
+					for (size_t group{}; group < groups; ++group)
+					{
+						const auto value{xoshiroStep<scrambler>(lanesState[group])};
+						std::memcpy(out + (((block * lanes) + (group * width)) * sizeof(uint64_t)), &value,
+							sizeof(word_t));
+					}
+				}
+
+				for (size_t group{}; group < groups; ++group)
+				{
+					for (size_t word{}; word < 4U; ++word)
+						std::memcpy(&state[(word * lanes) + (group * width)], &lanesState[group][word], sizeof(word_t));
+				}
+			}
+
+			template<xoshiroScrambler_t scrambler> void fillScalar(std::array<uint64_t, 32> &state,
+				uint8_t *const out, const size_t blocks) noexcept
+				{ fillLanes<scrambler, uint64_t>(state, out, blocks); }
+
+#if defined(__GNUC__) || defined(__clang__)
+#	define SUBSTRATE_PRNG_VECTORS 1
+			using u64x2_t = uint64_t __attribute__((vector_size(16)));
+#	if defined(SUBSTRATE_ARCH_X86)
+			using u64x4_t = uint64_t __attribute__((vector_size(32)));
+			using u64x8_t = uint64_t __attribute__((vector_size(64)));
+
+			template<xoshiroScrambler_t scrambler> SUBSTRATE_TARGET("avx512f") void fillAVX512(
+				std::array<uint64_t, 32> &state, uint8_t *const out, const size_t blocks) noexcept
+				{ fillLanes<scrambler, u64x8_t>(state, out, blocks); }
+
+			template<xoshiroScrambler_t scrambler> SUBSTRATE_TARGET("avx2") void fillAVX2(
+				std::array<uint64_t, 32> &state, uint8_t *const out, const size_t blocks) noexcept
+				{ fillLanes<scrambler, u64x4_t>(state, out, blocks); }
+#	endif
+
+			// SSE2 and NEON are part of the x86-64 and AArch64 baselines, so this needs no target of its own
+			template<xoshiroScrambler_t scrambler> void fill128(std::array<uint64_t, 32> &state,
+				uint8_t *const out, const size_t blocks) noexcept
+				{ fillLanes<scrambler, u64x2_t>(state, out, blocks); }
+#endif
+
+			template<xoshiroScrambler_t scrambler> fillKernel_t selectFillKernel() noexcept
+			{
+				SUBSTRATE_NOWARN_UNUSED(const auto &features){cpuFeatures()};
+#if defined(SUBSTRATE_PRNG_VECTORS)
+#	if defined(SUBSTRATE_ARCH_X86)
+				if (features.avx512)
+					return fillAVX512<scrambler>;
+				if (features.avx2)
+					return fillAVX2<scrambler>;
+#	endif
+#	if defined(__x86_64__) || defined(__SSE2__) || defined(SUBSTRATE_ARCH_AARCH64)
+				return fill128<scrambler>;
+#	endif
+#endif
+				return fillScalar<scrambler>;
+			}
+		} // namespace
+
+		const zigguratTable_t &normalZiggurat() noexcept
+		{
+			static const auto table{makeNormalZiggurat()};
+			return table;
+		}
+
+		const zigguratTable_t &exponentialZiggurat() noexcept
+		{
+			static const auto table{makeExponentialZiggurat()};
+			return table;
+		}
+
+		void xoshiro256x8Fill(std::array<uint64_t, 32> &state, uint8_t *const out, const size_t blocks,
+			const xoshiroScrambler_t scrambler) noexcept
+		{
+			static const std::array<fillKernel_t, 3> kernels
+			{{
+				selectFillKernel<xoshiroScrambler_t::plus>(),
+				selectFillKernel<xoshiroScrambler_t::plusPlus>(),
+				selectFillKernel<xoshiroScrambler_t::starStar>(),
+			}};
+			if (blocks)
+				kernels[size_t(scrambler)](state, out, blocks);
+		}
+	} // namespace internal
+} // namespace substrate
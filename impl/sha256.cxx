@@ -0,0 +1,667 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "substrate/crypto/sha256"
+#include "substrate/internal/cpu_features"
+
+#if defined(SUBSTRATE_ARCH_X86)
+#	include <immintrin.h>
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+#	include <arm_neon.h>
+#endif
+
+namespace substrate
+{
+	namespace crypto
+	{
+		namespace
+		{
+			namespace bu = substrate::buffer_utils;
+
+			/*
+			 * The compression function is written once over a generic word type so the same code serves
+			 * the scalar kernel (word_t = uint32_t) and the multi-buffer kernels, where word_t is a
+			 * compiler vector holding the same word from several independent messages.
+			 */
+#if defined(__GNUC__) && !defined(__clang__)
+			/*
+			 * Vector word types only ever pass between these always-inlined helpers so the ABI doesn't
+			 * matter. GCC reports this at the end of the translation unit, so it stays disabled from here on.
+			 */
+#	pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+			template<typename word_t> SUBSTRATE_ALWAYS_INLINE word_t rotr32(const word_t &value,
+				const uint32_t bits) noexcept
+				{ return (value >> bits) | (value << (32U - bits)); }
+
+			template<typename word_t> SUBSTRATE_ALWAYS_INLINE word_t sigma0(const word_t &value) noexcept
+				{ return rotr32(value, 7U) ^ rotr32(value, 18U) ^ (value >> 3U); }
+			template<typename word_t> SUBSTRATE_ALWAYS_INLINE word_t sigma1(const word_t &value) noexcept
+				{ return rotr32(value, 17U) ^ rotr32(value, 19U) ^ (value >> 10U); }
+
+			// Computes the next 16 words of the message schedule in place over the previous 16
+			template<typename word_t> SUBSTRATE_ALWAYS_INLINE void expandSchedule(std::array<word_t, 16> &W) noexcept
+			{
+				for (size_t i{}; i < 16U; ++i)
+					W[i] += sigma1(W[(i + 14U) & 15U]) + W[(i + 9U) & 15U] + sigma0(W[(i + 1U) & 15U]);
+			}
+
+			template<typename word_t> SUBSTRATE_ALWAYS_INLINE void step(const size_t n, const word_t &a,
+				const word_t &b, const word_t &c, word_t &d, const word_t &e, const word_t &f, const word_t &g,
+				word_t &h, const word_t &w) noexcept
+			{
+				const word_t t1{h + (rotr32(e, 6U) ^ rotr32(e, 11U) ^ rotr32(e, 25U)) +
+					((e & f) ^ (~e & g)) + k[n] + w};
+				const word_t t2{(rotr32(a, 2U) ^ rotr32(a, 13U) ^ rotr32(a, 22U)) + ((a & b) | (c & (a | b)))};
+				d += t1;
+				h = t1 + t2;
+			}
+
+			/*
+			 * Runs 8 rounds of the compression function. Rather than moving the working variables
+			 * along after each round, the roles of the variables rotate through the argument list
+			 * so that after 8 rounds everything is back where it started.
+			 */
+			template<typename word_t> SUBSTRATE_ALWAYS_INLINE void rounds8(const size_t n, word_t &a, word_t &b,
+				word_t &c, word_t &d, word_t &e, word_t &f, word_t &g, word_t &h, const std::array<word_t, 16> &W,
+				const size_t w) noexcept
+			{
+				step(n + 0U, a, b, c, d, e, f, g, h, W[w + 0U]);
+				step(n + 1U, h, a, b, c, d, e, f, g, W[w + 1U]);
+				step(n + 2U, g, h, a, b, c, d, e, f, W[w + 2U]);
+				step(n + 3U, f, g, h, a, b, c, d, e, W[w + 3U]);
+				step(n + 4U, e, f, g, h, a, b, c, d, W[w + 4U]);
+				step(n + 5U, d, e, f, g, h, a, b, c, W[w + 5U]);
+				step(n + 6U, c, d, e, f, g, h, a, b, W[w + 6U]);
+				step(n + 7U, b, c, d, e, f, g, h, a, W[w + 7U]);
+			}
+
+			// Compresses the 16 message words in W (which get clobbered by the schedule) into the state
+			template<typename word_t> SUBSTRATE_ALWAYS_INLINE void compress(std::array<word_t, 8> &state,
+				std::array<word_t, 16> &W) noexcept
+			{
+				auto a{state[0]};
+				auto b{state[1]};
+				auto c{state[2]};
+				auto d{state[3]};
+				auto e{state[4]};
+				auto f{state[5]};
+				auto g{state[6]};
+				auto h{state[7]};
+
+				rounds8(0U, a, b, c, d, e, f, g, h, W, 0U);
+				rounds8(8U, a, b, c, d, e, f, g, h, W, 8U);
+				expandSchedule(W);
+				rounds8(16U, a, b, c, d, e, f, g, h, W, 0U);
+				rounds8(24U, a, b, c, d, e, f, g, h, W, 8U);
+				expandSchedule(W);
+				rounds8(32U, a, b, c, d, e, f, g, h, W, 0U);
+				rounds8(40U, a, b, c, d, e, f, g, h, W, 8U);
+				expandSchedule(W);
+				rounds8(48U, a, b, c, d, e, f, g, h, W, 0U);
+				rounds8(56U, a, b, c, d, e, f, g, h, W, 8U);
+
+				state[0] += a;
+				state[1] += b;
+				state[2] += c;
+				state[3] += d;
+				state[4] += e;
+				state[5] += f;
+				state[6] += g;
+				state[7] += h;
+			}
+
+			void sha256Scalar(std::array<uint32_t, 8> &state, const uint8_t *data, size_t blocks) noexcept
+			{
+				std::array<uint32_t, 16> W{};
+				for (; blocks; --blocks, data += sha256_t::blockSize)
+				{
+					for (size_t i{}; i < W.size(); ++i)
+						W[i] = bu::readBE<uint32_t>(data + (i * sizeof(uint32_t)));
+					compress(state, W);
+				}
+			}
+
+#if defined(SUBSTRATE_ARCH_X86)
+			inline __m128i load128(const void *const data) noexcept
+			{
+				__m128i value{};
+				std::memcpy(&value, data, sizeof(value));
+				return value;
+			}
+
+			inline void store128(void *const data, const __m128i value) noexcept
+				{ std::memcpy(data, &value, sizeof(value)); }
+
+			// Performs 4 rounds, SHA-NI holds the state as the {A, B, E, F} and {C, D, G, H} halves
+			SUBSTRATE_TARGET("sha,sse4.1") inline void quadRoundSHANI(__m128i &abef, __m128i &cdgh,
+				const __m128i msg, const size_t n) noexcept
+			{
+				auto wk{_mm_add_epi32(msg, load128(k.data() + n))};
+				cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);
+				wk = _mm_shuffle_epi32(wk, 0x0E);
+				abef = _mm_sha256rnds2_epu32(abef, cdgh, wk);
+			}
+
+			// Computes message words W[n + 16] through W[n + 19] from the previous 16
+			SUBSTRATE_TARGET("sha,sse4.1") inline __m128i expandSHANI(const __m128i msg0, const __m128i msg1,
+				const __m128i msg2, const __m128i msg3) noexcept
+			{
+				const auto words{_mm_add_epi32(_mm_sha256msg1_epu32(msg0, msg1), _mm_alignr_epi8(msg3, msg2, 4))};
+				return _mm_sha256msg2_epu32(words, msg3);
+			}
+
+			SUBSTRATE_TARGET("sha,sse4.1") void sha256SHANI(std::array<uint32_t, 8> &state, const uint8_t *data,
+				size_t blocks) noexcept
+			{
+				const auto byteSwap{_mm_set_epi64x(0x0C0D0E0F08090A0B, 0x0405060700010203)};
+				// Rearrange {A, B, C, D}, {E, F, G, H} into the {F, E, B, A}, {H, G, D, C} lane order
+				const auto dcba{_mm_shuffle_epi32(load128(state.data()), 0xB1)};
+				const auto hgfe{_mm_shuffle_epi32(load128(state.data() + 4), 0x1B)};
+				auto abef{_mm_alignr_epi8(dcba, hgfe, 8)};
+				auto cdgh{_mm_blend_epi16(hgfe, dcba, 0xF0)};
+
+				for (; blocks; --blocks, data += sha256_t::blockSize)
+				{
+					const auto abefSaved{abef};
+					const auto cdghSaved{cdgh};
+
+					auto msg0{_mm_shuffle_epi8(load128(data), byteSwap)};
+					auto msg1{_mm_shuffle_epi8(load128(data + 16), byteSwap)};
+					auto msg2{_mm_shuffle_epi8(load128(data + 32), byteSwap)};
+					auto msg3{_mm_shuffle_epi8(load128(data + 48), byteSwap)};
+
+					quadRoundSHANI(abef, cdgh, msg0, 0U);
+					quadRoundSHANI(abef, cdgh, msg1, 4U);
+					quadRoundSHANI(abef, cdgh, msg2, 8U);
+					quadRoundSHANI(abef, cdgh, msg3, 12U);
+					for (size_t n{16U}; n < k.size(); n += 16U)
+					{
+						msg0 = expandSHANI(msg0, msg1, msg2, msg3);
+						quadRoundSHANI(abef, cdgh, msg0, n);
+						msg1 = expandSHANI(msg1, msg2, msg3, msg0);
+						quadRoundSHANI(abef, cdgh, msg1, n + 4U);
+						msg2 = expandSHANI(msg2, msg3, msg0, msg1);
+						quadRoundSHANI(abef, cdgh, msg2, n + 8U);
+						msg3 = expandSHANI(msg3, msg0, msg1, msg2);
+						quadRoundSHANI(abef, cdgh, msg3, n + 12U);
+					}
+
+					abef = _mm_add_epi32(abef, abefSaved);
+					cdgh = _mm_add_epi32(cdgh, cdghSaved);
+				}
+
+				const auto feba{_mm_shuffle_epi32(abef, 0x1B)};
+				const auto dchg{_mm_shuffle_epi32(cdgh, 0xB1)};
+				store128(state.data(), _mm_blend_epi16(feba, dchg, 0xF0));
+				store128(state.data() + 4, _mm_alignr_epi8(dchg, feba, 8));
+			}
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+			inline uint32x4_t loadBE(const uint8_t *const data) noexcept
+				{ return vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data))); }
+
+			SUBSTRATE_TARGET("+sha2") inline void quadRoundARMv8(uint32x4_t &abcd, uint32x4_t &efgh, const uint32x4_t msg,
+				const size_t n) noexcept
+			{
+				const auto wk{vaddq_u32(msg, vld1q_u32(k.data() + n))};
+				const auto abcdSaved{abcd};
+				abcd = vsha256hq_u32(abcd, efgh, wk);
+				efgh = vsha256h2q_u32(efgh, abcdSaved, wk);
+			}
+
+			SUBSTRATE_TARGET("+sha2") inline uint32x4_t expandARMv8(const uint32x4_t msg0, const uint32x4_t msg1, const uint32x4_t msg2,
+				const uint32x4_t msg3) noexcept
+				{ return vsha256su1q_u32(vsha256su0q_u32(msg0, msg1), msg2, msg3); }
+
+			SUBSTRATE_TARGET("+sha2") void sha256ARMv8(std::array<uint32_t, 8> &state, const uint8_t *data, size_t blocks) noexcept
+			{
+				auto abcd{vld1q_u32(state.data())};
+				auto efgh{vld1q_u32(state.data() + 4)};
+
+				for (; blocks; --blocks, data += sha256_t::blockSize)
+				{
+					const auto abcdSaved{abcd};
+					const auto efghSaved{efgh};
+
+					auto msg0{loadBE(data)};
+					auto msg1{loadBE(data + 16)};
+					auto msg2{loadBE(data + 32)};
+					auto msg3{loadBE(data + 48)};
+
+					quadRoundARMv8(abcd, efgh, msg0, 0U);
+					quadRoundARMv8(abcd, efgh, msg1, 4U);
+					quadRoundARMv8(abcd, efgh, msg2, 8U);
+					quadRoundARMv8(abcd, efgh, msg3, 12U);
+					for (size_t n{16U}; n < k.size(); n += 16U)
+					{
+						msg0 = expandARMv8(msg0, msg1, msg2, msg3);
+						quadRoundARMv8(abcd, efgh, msg0, n);
+						msg1 = expandARMv8(msg1, msg2, msg3, msg0);
+						quadRoundARMv8(abcd, efgh, msg1, n + 4U);
+						msg2 = expandARMv8(msg2, msg3, msg0, msg1);
+						quadRoundARMv8(abcd, efgh, msg2, n + 8U);
+						msg3 = expandARMv8(msg3, msg0, msg1, msg2);
+						quadRoundARMv8(abcd, efgh, msg3, n + 12U);
+					}
+
+					abcd = vaddq_u32(abcd, abcdSaved);
+					efgh = vaddq_u32(efgh, efghSaved);
+				}
+
+				vst1q_u32(state.data(), abcd);
+				vst1q_u32(state.data() + 4, efgh);
+			}
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#	define SUBSTRATE_SHA256_LANES 1
+			/*
+			 * Multi-buffer hashing runs the generic compression function over compiler vectors, each
+			 * lane of which carries one message. The state is kept word-major ({A of each lane}, {B of
+			 * each lane}, ..) so it can be loaded straight into the vectors.
+			 */
+			using u32x4_t = uint32_t __attribute__((vector_size(16)));
+			using u32x8_t = uint32_t __attribute__((vector_size(32)));
+			using u32x16_t = uint32_t __attribute__((vector_size(64)));
+			using lanesKernel_t = void (*)(uint32_t *, const uint8_t *const *, size_t) noexcept;
+
+			template<typename vector_t> SUBSTRATE_ALWAYS_INLINE void loadState(std::array<vector_t, 8> &state,
+				const uint32_t *const stateWords) noexcept
+			{
+				constexpr auto lanes{sizeof(vector_t) / sizeof(uint32_t)};
+				for (size_t i{}; i < state.size(); ++i)
+					std::memcpy(&state[i], stateWords + (i * lanes), sizeof(vector_t));
+			}
+
+			template<typename vector_t> SUBSTRATE_ALWAYS_INLINE void storeState(uint32_t *const stateWords,
+				const std::array<vector_t, 8> &state) noexcept
+			{
+				constexpr auto lanes{sizeof(vector_t) / sizeof(uint32_t)};
+				for (size_t i{}; i < state.size(); ++i)
+					std::memcpy(stateWords + (i * lanes), &state[i], sizeof(vector_t));
+			}
+
+			/*
+			 * The loaders fetch the 16 message words of a block for every lane, transposed so W[i] holds
+			 * word i of each lane's block. This generic one simply gathers the words one at a time.
+			 */
+			template<typename vector_t> SUBSTRATE_ALWAYS_INLINE void gatherWords(std::array<vector_t, 16> &W,
+				const uint8_t *const *const data, const size_t offset) noexcept
+			{
+				constexpr auto lanes{sizeof(vector_t) / sizeof(uint32_t)};
+				std::array<uint32_t, lanes> words{};
+				for (size_t i{}; i < W.size(); ++i)
+				{
+					for (size_t lane{}; lane < lanes; ++lane)
+						words[lane] = bu::readBE<uint32_t>(data[lane] + offset + (i * sizeof(uint32_t)));
+					std::memcpy(&W[i], words.data(), sizeof(vector_t));
+				}
+			}
+
+#	if defined(SUBSTRATE_ARCH_X86)
+			SUBSTRATE_TARGET("avx512f") SUBSTRATE_ALWAYS_INLINE void storeWord(u32x16_t &word,
+				const __m512i value) noexcept
+				{ std::memcpy(&word, &value, sizeof(word)); }
+
+			// Loads each lane's block whole, then byte swaps and transposes the 16x16 matrix of words
+			SUBSTRATE_TARGET("avx512f,avx512bw") SUBSTRATE_ALWAYS_INLINE void transposeAVX512(
+				std::array<u32x16_t, 16> &W, const uint8_t *const *const data, const size_t offset) noexcept
+			{
+				const auto byteSwap{_mm512_set4_epi32(0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203)};
+				// The unmasked forms of these shuffles trip GCC's uninitialised variable checks, and a full
+				// mask compiles back down to them
+				const __mmask16 allWords{0xFFFFU};
+				const __mmask8 allQuads{0xFFU};
+				// NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+				__m512i rows[16];
+				for (size_t lane{}; lane < 16U; ++lane)
+					rows[lane] = _mm512_shuffle_epi8(_mm512_loadu_si512(data[lane] + offset), byteSwap);
+
+				// After this, 128-bit lane k of quads[g][j] holds word 4k + j of rows 4g through 4g + 3
+				// NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+				__m512i quads[4][4];
+				for (size_t group{}; group < 4U; ++group)
+				{
+					const auto lo01{_mm512_maskz_unpacklo_epi32(allWords, rows[group * 4U], rows[(group * 4U) + 1U])};
+					const auto hi01{_mm512_maskz_unpackhi_epi32(allWords, rows[group * 4U], rows[(group * 4U) + 1U])};
+					const auto lo23{_mm512_maskz_unpacklo_epi32(allWords, rows[(group * 4U) + 2U], rows[(group * 4U) + 3U])};
+					const auto hi23{_mm512_maskz_unpackhi_epi32(allWords, rows[(group * 4U) + 2U], rows[(group * 4U) + 3U])};
+					quads[group][0] = _mm512_maskz_unpacklo_epi64(allQuads, lo01, lo23);
+					quads[group][1] = _mm512_maskz_unpackhi_epi64(allQuads, lo01, lo23);
+					quads[group][2] = _mm512_maskz_unpacklo_epi64(allQuads, hi01, hi23);
+					quads[group][3] = _mm512_maskz_unpackhi_epi64(allQuads, hi01, hi23);
+				}
+
+				// Then gather the matching 128-bit lanes from each group together
+				for (size_t word{}; word < 4U; ++word)
+				{
+					const auto lo01{_mm512_maskz_shuffle_i32x4(allWords, quads[0][word], quads[1][word], 0x44)};
+					const auto lo23{_mm512_maskz_shuffle_i32x4(allWords, quads[2][word], quads[3][word], 0x44)};
+					const auto hi01{_mm512_maskz_shuffle_i32x4(allWords, quads[0][word], quads[1][word], 0xEE)};
+					const auto hi23{_mm512_maskz_shuffle_i32x4(allWords, quads[2][word], quads[3][word], 0xEE)};
+					storeWord(W[word], _mm512_maskz_shuffle_i32x4(allWords, lo01, lo23, 0x88));
+					storeWord(W[word + 4U], _mm512_maskz_shuffle_i32x4(allWords, lo01, lo23, 0xDD));
+					storeWord(W[word + 8U], _mm512_maskz_shuffle_i32x4(allWords, hi01, hi23, 0x88));
+					storeWord(W[word + 12U], _mm512_maskz_shuffle_i32x4(allWords, hi01, hi23, 0xDD));
+				}
+			}
+
+			// Loads each lane's block as two halves, then byte swaps and transposes each 8x8 matrix of words
+			SUBSTRATE_TARGET("avx2") SUBSTRATE_ALWAYS_INLINE void transposeAVX2(std::array<u32x8_t, 16> &W,
+				const uint8_t *const *const data, const size_t offset) noexcept
+			{
+				const auto byteSwap{_mm256_set_epi32(0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203,
+					0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203)};
+				for (size_t half{}; half < 2U; ++half)
+				{
+					// NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+					__m256i rows[8];
+					for (size_t lane{}; lane < 8U; ++lane)
+					{
+						__m256i row{};
+						std::memcpy(&row, data[lane] + offset + (half * 32U), sizeof(row));
+						rows[lane] = _mm256_shuffle_epi8(row, byteSwap);
+					}
+
+					// NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+					__m256i quads[2][4];
+					for (size_t group{}; group < 2U; ++group)
+					{
+						const auto lo01{_mm256_unpacklo_epi32(rows[group * 4U], rows[(group * 4U) + 1U])};
+						const auto hi01{_mm256_unpackhi_epi32(rows[group * 4U], rows[(group * 4U) + 1U])};
+						const auto lo23{_mm256_unpacklo_epi32(rows[(group * 4U) + 2U], rows[(group * 4U) + 3U])};
+						const auto hi23{_mm256_unpackhi_epi32(rows[(group * 4U) + 2U], rows[(group * 4U) + 3U])};
+						quads[group][0] = _mm256_unpacklo_epi64(lo01, lo23);
+						quads[group][1] = _mm256_unpackhi_epi64(lo01, lo23);
+						quads[group][2] = _mm256_unpacklo_epi64(hi01, hi23);
+						quads[group][3] = _mm256_unpackhi_epi64(hi01, hi23);
+					}
+
+					for (size_t word{}; word < 4U; ++word)
+					{
+						const auto low{_mm256_permute2x128_si256(quads[0][word], quads[1][word], 0x20)};
+						const auto high{_mm256_permute2x128_si256(quads[0][word], quads[1][word], 0x31)};
+						std::memcpy(&W[(half * 8U) + word], &low, sizeof(low));
+						std::memcpy(&W[(half * 8U) + word + 4U], &high, sizeof(high));
+					}
+				}
+			}
+
+			SUBSTRATE_TARGET("avx512f,avx512bw") void sha256x16AVX512(uint32_t *const state,
+				const uint8_t *const *const data, const size_t blocks) noexcept
+			{
+				std::array<u32x16_t, 8> lanes{};
+				std::array<u32x16_t, 16> W{};
+				loadState(lanes, state);
+				for (size_t block{}; block < blocks; ++block)
+				{
+					transposeAVX512(W, data, block * sha256_t::blockSize);
+					compress(lanes, W);
+				}
+				storeState(state, lanes);
+			}
+
+			SUBSTRATE_TARGET("avx2") void sha256x8AVX2(uint32_t *const state, const uint8_t *const *const data,
+				const size_t blocks) noexcept
+			{
+				std::array<u32x8_t, 8> lanes{};
+				std::array<u32x8_t, 16> W{};
+				loadState(lanes, state);
+				for (size_t block{}; block < blocks; ++block)
+				{
+					transposeAVX2(W, data, block * sha256_t::blockSize);
+					compress(lanes, W);
+				}
+				storeState(state, lanes);
+			}
+#	endif
+
+#	if defined(SUBSTRATE_ARCH_AARCH64) || defined(__x86_64__) || defined(__SSE2__)
+			// SSE2 and NEON are baseline on x86-64 and AArch64 respectively, so this needs no target
+			void sha256x4(uint32_t *const state, const uint8_t *const *const data, const size_t blocks) noexcept
+			{
+				std::array<u32x4_t, 8> lanes{};
+				std::array<u32x4_t, 16> W{};
+				loadState(lanes, state);
+				for (size_t block{}; block < blocks; ++block)
+				{
+					gatherWords(W, data, block * sha256_t::blockSize);
+					compress(lanes, W);
+				}
+				storeState(state, lanes);
+			}
+#	endif
+#endif
+
+			using tail_t = std::array<uint8_t, sha256_t::blockSize * 2U>;
+
+			// Builds the padded final block(s) of a message, returning how many blocks that came to
+			size_t padMessage(const span<const uint8_t> &message, tail_t &tail) noexcept
+			{
+				tail.fill(0U);
+				const auto tailLength{message.size() % sha256_t::blockSize};
+				if (tailLength)
+					std::memcpy(tail.data(), message.data() + (message.size() - tailLength), tailLength);
+				tail[tailLength] = 0x80U;
+				const size_t blocks{tailLength + 1U + sizeof(uint64_t) > sha256_t::blockSize ? 2U : 1U};
+				bu::writeBE(uint64_t{message.size()} << 3U,
+					tail.data() + (blocks * sha256_t::blockSize) - sizeof(uint64_t));
+				return blocks;
+			}
+
+			void writeDigest(const std::array<uint32_t, 8> &state, sha256_t::digest_t &digest) noexcept
+			{
+				for (size_t i{}; i < state.size(); ++i)
+					bu::writeBE(state[i], digest.data() + (i * sizeof(uint32_t)));
+			}
+
+			// Compresses the final block(s) of a message whose whole blocks are already in state
+			void finishMessage(std::array<uint32_t, 8> state, const span<const uint8_t> &message,
+				sha256_t::digest_t &digest) noexcept
+			{
+				tail_t tail{};
+				internal::sha256Blocks(state, tail.data(), padMessage(message, tail));
+				writeDigest(state, digest);
+			}
+
+			constexpr std::array<uint32_t, 8> initialState
+			{{
+				UINT32_C(0x6A09E667), UINT32_C(0xBB67AE85), UINT32_C(0x3C6EF372), UINT32_C(0xA54FF53A),
+				UINT32_C(0x510E527F), UINT32_C(0x9B05688C), UINT32_C(0x1F83D9AB), UINT32_C(0x5BE0CD19),
+			}};
+
+#if defined(SUBSTRATE_SHA256_LANES)
+			/*
+			 * Keeps every lane of the multi-buffer kernel busy by refilling a lane with the next message as
+			 * soon as its current one is done. Each message goes through a lane twice: first its whole
+			 * blocks straight from the caller's buffer, then its padded final block(s) from a lane-local copy.
+			 */
+			template<lanesKernel_t kernel, size_t lanes> void hashLanes(const span<const span<const uint8_t>> &messages,
+				const span<sha256_t::digest_t> &digests) noexcept
+			{
+				const auto count{std::min(messages.size(), digests.size())};
+				std::array<uint32_t, 8U * lanes> state{};
+				std::array<const uint8_t *, lanes> data{};
+				std::array<size_t, lanes> blocks{};
+				std::array<size_t, lanes> message{};
+				std::array<bool, lanes> finishing{};
+				std::array<tail_t, lanes> tails{};
+				size_t next{};
+				size_t active{};
+
+				const auto laneState{[&](const size_t lane) noexcept
+				{
+					std::array<uint32_t, 8> result{};
+					for (size_t i{}; i < result.size(); ++i)
+						result[i] = state[(i * lanes) + lane];
+					return result;
+				}};
+
+				const auto startTail{[&](const size_t lane) noexcept
+				{
+					blocks[lane] = padMessage(messages[message[lane]], tails[lane]);
+					data[lane] = tails[lane].data();
+					finishing[lane] = true;
+				}};
+
+				const auto fill{[&](const size_t lane) noexcept
+				{
+					if (next == count)
+						return;
+					const auto &msg{messages[next]};
+					for (size_t i{}; i < initialState.size(); ++i)
+						state[(i * lanes) + lane] = initialState[i];
+					message[lane] = next++;
+					data[lane] = msg.data();
+					blocks[lane] = msg.size() / sha256_t::blockSize;
+					finishing[lane] = false;
+					++active;
+					if (!blocks[lane])
+						startTail(lane);
+				}};
+
+				for (size_t lane{}; lane < lanes; ++lane)
+					fill(lane);
+
+				// Once there are no more messages to start, stop when less than half the lanes are doing useful work
+				while (active && (next < count || active * 2U >= lanes))
+				{
+					auto steps{std::numeric_limits<size_t>::max()};
+					size_t busyLane{};
+					for (size_t lane{}; lane < lanes; ++lane)
+					{
+						if (blocks[lane] && blocks[lane] < steps)
+						{
+							steps = blocks[lane];
+							busyLane = lane;
+						}
+					}
+					// Idle lanes shadow a busy one so they only read valid memory, their results get thrown away
+					for (size_t lane{}; lane < lanes; ++lane)
+					{
+						if (!blocks[lane])
+							data[lane] = data[busyLane];
+					}
+
+					kernel(state.data(), data.data(), steps);
+
+					for (size_t lane{}; lane < lanes; ++lane)
+					{
+						if (!blocks[lane])
+							continue;
+						data[lane] += steps * sha256_t::blockSize;
+						blocks[lane] -= steps;
+						if (blocks[lane])
+							continue;
+						if (!finishing[lane])
+							startTail(lane);
+						else
+						{
+							writeDigest(laneState(lane), digests[message[lane]]);
+							--active;
+							fill(lane);
+						}
+					}
+				}
+
+				for (size_t lane{}; lane < lanes; ++lane)
+				{
+					if (!blocks[lane])
+						continue;
+					auto remaining{laneState(lane)};
+					internal::sha256Blocks(remaining, data[lane], blocks[lane]);
+					if (finishing[lane])
+						writeDigest(remaining, digests[message[lane]]);
+					else
+						finishMessage(remaining, messages[message[lane]], digests[message[lane]]);
+				}
+			}
+#endif
+
+			// Hashes the messages one after another, for when the SHA extensions make that the fastest way
+			void hashSerial(const span<const span<const uint8_t>> &messages,
+				const span<sha256_t::digest_t> &digests) noexcept
+			{
+				const auto count{std::min(messages.size(), digests.size())};
+				for (size_t i{}; i < count; ++i)
+				{
+					std::array<uint32_t, 8> state{initialState};
+					const auto &message{messages[i]};
+					internal::sha256Blocks(state, message.data(), message.size() / sha256_t::blockSize);
+					finishMessage(state, message, digests[i]);
+				}
+			}
+		} // namespace
+	} // namespace crypto
+
+	namespace internal
+	{
+		kernels_t<sha256Kernel_t> sha256Kernels() noexcept
+		{
+			SUBSTRATE_NOWARN_UNUSED(const auto &features){cpuFeatures()};
+			kernels_t<sha256Kernel_t> kernels{};
+#if defined(SUBSTRATE_ARCH_X86)
+			if (features.sha && features.sse42)
+				kernels.add("SHA-NI", crypto::sha256SHANI);
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+			if (features.sha)
+				kernels.add("ARMv8", crypto::sha256ARMv8);
+#endif
+			kernels.add("scalar", crypto::sha256Scalar);
+			return kernels;
+		}
+
+		kernels_t<sha256ManyKernel_t> sha256ManyKernels() noexcept
+		{
+			SUBSTRATE_NOWARN_UNUSED(const auto &features){cpuFeatures()};
+			kernels_t<sha256ManyKernel_t> kernels{};
+			// One message at a time through the SHA extensions beats anything short of 16 lanes, when
+			// that's what sha256Blocks() will be using
+			const bool extensions{sha256Kernels().front().function != crypto::sha256Scalar};
+#if defined(SUBSTRATE_SHA256_LANES)
+#	if defined(SUBSTRATE_ARCH_X86)
+			if (features.avx512)
+				kernels.add("AVX-512 x16", crypto::hashLanes<crypto::sha256x16AVX512, 16U>);
+#	endif
+			if (extensions)
+				kernels.add("serial", crypto::hashSerial);
+#	if defined(SUBSTRATE_ARCH_X86)
+			if (features.avx2)
+				kernels.add("AVX2 x8", crypto::hashLanes<crypto::sha256x8AVX2, 8U>);
+#	endif
+#	if defined(SUBSTRATE_ARCH_AARCH64) || defined(__x86_64__) || defined(__SSE2__)
+			kernels.add("x4", crypto::hashLanes<crypto::sha256x4, 4U>);
+#	endif
+			if (!extensions)
+				kernels.add("serial", crypto::hashSerial);
+#else
+			kernels.add("serial", crypto::hashSerial);
+#endif
+			return kernels;
+		}
+
+		void sha256Blocks(std::array<uint32_t, 8> &state, const uint8_t *const data, const size_t blocks) noexcept
+		{
+			static const auto kernel{sha256Kernels().front().function};
+			if (!data || !blocks)
+				return;
+			kernel(state, data, blocks);
+		}
+	} // namespace internal
+
+	namespace crypto
+	{
+		void sha256_many(const span<const span<const uint8_t>> &messages,
+			const span<sha256_t::digest_t> &digests) noexcept
+		{
+			static const auto kernel{internal::sha256ManyKernels().front().function};
+			kernel(messages, digests);
+		}
+	} // namespace crypto
+
+} // namespace substrate
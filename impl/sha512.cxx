@@ -0,0 +1,328 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "substrate/crypto/sha512"
+#include "substrate/internal/cpu_features"
+
+#if defined(SUBSTRATE_ARCH_X86)
+#	include <immintrin.h>
+#	if (defined(__clang__) && __clang_major__ >= 18) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 14)
+// The SHA512 extension intrinsics first shipped with GCC 14 and Clang 18
+#		define SUBSTRATE_SHA512_NI 1
+#	endif
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+#	include <arm_neon.h>
+#	if (defined(__clang__) && __clang_major__ >= 16) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 8) || \
+		defined(__ARM_FEATURE_SHA512)
+// The SHA512 intrinsics can be had with a per-function target from GCC 8 and Clang 16
+#		define SUBSTRATE_SHA512_ARMV8 1
+#	endif
+#endif
+
+namespace substrate
+{
+	namespace crypto
+	{
+		namespace
+		{
+			namespace bu = substrate::buffer_utils;
+
+			constexpr std::array<uint64_t, 80> k
+			{{
+				UINT64_C(0x428A2F98D728AE22), UINT64_C(0x7137449123EF65CD),
+				UINT64_C(0xB5C0FBCFEC4D3B2F), UINT64_C(0xE9B5DBA58189DBBC),
+				UINT64_C(0x3956C25BF348B538), UINT64_C(0x59F111F1B605D019),
+				UINT64_C(0x923F82A4AF194F9B), UINT64_C(0xAB1C5ED5DA6D8118),
+				UINT64_C(0xD807AA98A3030242), UINT64_C(0x12835B0145706FBE),
+				UINT64_C(0x243185BE4EE4B28C), UINT64_C(0x550C7DC3D5FFB4E2),
+				UINT64_C(0x72BE5D74F27B896F), UINT64_C(0x80DEB1FE3B1696B1),
+				UINT64_C(0x9BDC06A725C71235), UINT64_C(0xC19BF174CF692694),
+				UINT64_C(0xE49B69C19EF14AD2), UINT64_C(0xEFBE4786384F25E3),
+				UINT64_C(0x0FC19DC68B8CD5B5), UINT64_C(0x240CA1CC77AC9C65),
+				UINT64_C(0x2DE92C6F592B0275), UINT64_C(0x4A7484AA6EA6E483),
+				UINT64_C(0x5CB0A9DCBD41FBD4), UINT64_C(0x76F988DA831153B5),
+				UINT64_C(0x983E5152EE66DFAB), UINT64_C(0xA831C66D2DB43210),
+				UINT64_C(0xB00327C898FB213F), UINT64_C(0xBF597FC7BEEF0EE4),
+				UINT64_C(0xC6E00BF33DA88FC2), UINT64_C(0xD5A79147930AA725),
+				UINT64_C(0x06CA6351E003826F), UINT64_C(0x142929670A0E6E70),
+				UINT64_C(0x27B70A8546D22FFC), UINT64_C(0x2E1B21385C26C926),
+				UINT64_C(0x4D2C6DFC5AC42AED), UINT64_C(0x53380D139D95B3DF),
+				UINT64_C(0x650A73548BAF63DE), UINT64_C(0x766A0ABB3C77B2A8),
+				UINT64_C(0x81C2C92E47EDAEE6), UINT64_C(0x92722C851482353B),
+				UINT64_C(0xA2BFE8A14CF10364), UINT64_C(0xA81A664BBC423001),
+				UINT64_C(0xC24B8B70D0F89791), UINT64_C(0xC76C51A30654BE30),
+				UINT64_C(0xD192E819D6EF5218), UINT64_C(0xD69906245565A910),
+				UINT64_C(0xF40E35855771202A), UINT64_C(0x106AA07032BBD1B8),
+				UINT64_C(0x19A4C116B8D2D0C8), UINT64_C(0x1E376C085141AB53),
+				UINT64_C(0x2748774CDF8EEB99), UINT64_C(0x34B0BCB5E19B48A8),
+				UINT64_C(0x391C0CB3C5C95A63), UINT64_C(0x4ED8AA4AE3418ACB),
+				UINT64_C(0x5B9CCA4F7763E373), UINT64_C(0x682E6FF3D6B2B8A3),
+				UINT64_C(0x748F82EE5DEFB2FC), UINT64_C(0x78A5636F43172F60),
+				UINT64_C(0x84C87814A1F0AB72), UINT64_C(0x8CC702081A6439EC),
+				UINT64_C(0x90BEFFFA23631E28), UINT64_C(0xA4506CEBDE82BDE9),
+				UINT64_C(0xBEF9A3F7B2C67915), UINT64_C(0xC67178F2E372532B),
+				UINT64_C(0xCA273ECEEA26619C), UINT64_C(0xD186B8C721C0C207),
+				UINT64_C(0xEADA7DD6CDE0EB1E), UINT64_C(0xF57D4F7FEE6ED178),
+				UINT64_C(0x06F067AA72176FBA), UINT64_C(0x0A637DC5A2C898A6),
+				UINT64_C(0x113F9804BEF90DAE), UINT64_C(0x1B710B35131C471B),
+				UINT64_C(0x28DB77F523047D84), UINT64_C(0x32CAAB7B40C72493),
+				UINT64_C(0x3C9EBE0A15C9BEBC), UINT64_C(0x431D67C49C100D4C),
+				UINT64_C(0x4CC5D4BECB3E42B6), UINT64_C(0x597F299CFC657E2A),
+				UINT64_C(0x5FCB6FAB3AD6FAEC), UINT64_C(0x6C44198C4A475817)
+			}};
+
+			inline uint64_t Sigma0(const uint64_t value) noexcept
+				{ return rotr(value, 28U) ^ rotr(value, 34U) ^ rotr(value, 39U); }
+			inline uint64_t Sigma1(const uint64_t value) noexcept
+				{ return rotr(value, 14U) ^ rotr(value, 18U) ^ rotr(value, 41U); }
+			inline uint64_t sigma0(const uint64_t value) noexcept
+				{ return rotr(value, 1U) ^ rotr(value, 8U) ^ (value >> 7U); }
+			inline uint64_t sigma1(const uint64_t value) noexcept
+				{ return rotr(value, 19U) ^ rotr(value, 61U) ^ (value >> 6U); }
+
+			SUBSTRATE_ALWAYS_INLINE void step(const uint64_t a, const uint64_t b, const uint64_t c, uint64_t &d,
+				const uint64_t e, const uint64_t f, const uint64_t g, uint64_t &h, const uint64_t wk) noexcept
+			{
+				const uint64_t t1{h + Sigma1(e) + (g ^ (e & (f ^ g))) + wk};
+				d += t1;
+				h = t1 + Sigma0(a) + (b ^ ((a ^ b) & (b ^ c)));
+			}
+
+			/*
+			 * Runs 8 rounds of the compression function over message words W and round constants K.
+			 * As with SHA-256, the roles of the working variables rotate through the argument list
+			 * instead of the variables being shuffled along after every round.
+			 */
+			SUBSTRATE_ALWAYS_INLINE void rounds8(uint64_t &a, uint64_t &b, uint64_t &c, uint64_t &d, uint64_t &e,
+				uint64_t &f, uint64_t &g, uint64_t &h, const uint64_t *const W, const uint64_t *const K) noexcept
+			{
+				step(a, b, c, d, e, f, g, h, W[0] + K[0]);
+				step(h, a, b, c, d, e, f, g, W[1] + K[1]);
+				step(g, h, a, b, c, d, e, f, W[2] + K[2]);
+				step(f, g, h, a, b, c, d, e, W[3] + K[3]);
+				step(e, f, g, h, a, b, c, d, W[4] + K[4]);
+				step(d, e, f, g, h, a, b, c, W[5] + K[5]);
+				step(c, d, e, f, g, h, a, b, W[6] + K[6]);
+				step(b, c, d, e, f, g, h, a, W[7] + K[7]);
+			}
+
+			using schedule_t = std::array<uint64_t, 80>;
+
+			// Runs all 80 rounds over a fully expanded message schedule
+			SUBSTRATE_ALWAYS_INLINE void compress(std::array<uint64_t, 8> &state, const schedule_t &W) noexcept
+			{
+				auto a{state[0]};
+				auto b{state[1]};
+				auto c{state[2]};
+				auto d{state[3]};
+				auto e{state[4]};
+				auto f{state[5]};
+				auto g{state[6]};
+				auto h{state[7]};
+
+				for (size_t n{}; n < W.size(); n += 16U)
+				{
+					rounds8(a, b, c, d, e, f, g, h, W.data() + n, k.data() + n);
+					rounds8(a, b, c, d, e, f, g, h, W.data() + n + 8U, k.data() + n + 8U);
+				}
+
+				state[0] += a;
+				state[1] += b;
+				state[2] += c;
+				state[3] += d;
+				state[4] += e;
+				state[5] += f;
+				state[6] += g;
+				state[7] += h;
+			}
+
+			void sha512Scalar(std::array<uint64_t, 8> &state, const uint8_t *data, size_t blocks) noexcept
+			{
+				schedule_t W{};
+				for (; blocks; --blocks, data += sha512_t::blockSize)
+				{
+					for (size_t i{}; i < 16U; ++i)
+						W[i] = bu::readBE<uint64_t>(data + (i * sizeof(uint64_t)));
+					for (size_t i{16U}; i < W.size(); ++i)
+						W[i] = sigma1(W[i - 2U]) + W[i - 7U] + sigma0(W[i - 15U]) + W[i - 16U];
+					compress(state, W);
+				}
+			}
+
+#if defined(SUBSTRATE_SHA512_NI)
+			SUBSTRATE_TARGET("avx2") inline __m256i load256(const void *const data) noexcept
+			{
+				__m256i value{};
+				std::memcpy(&value, data, sizeof(value));
+				return value;
+			}
+
+			SUBSTRATE_TARGET("avx2") inline void store256(void *const data, const __m256i value) noexcept
+				{ std::memcpy(data, &value, sizeof(value)); }
+
+			// Picks words 1 through 4 out of the 8 words spanning low and high
+			SUBSTRATE_TARGET("avx2") inline __m256i alignWords(const __m256i high, const __m256i low) noexcept
+				{ return _mm256_alignr_epi8(_mm256_permute2x128_si256(low, high, 0x21), low, 8); }
+
+			// Performs 4 rounds, like SHA-NI the state is held as the {A, B, E, F} and {C, D, G, H} halves
+			SUBSTRATE_TARGET("sha512,avx2") inline void quadRoundSHA512(__m256i &abef, __m256i &cdgh,
+				const __m256i msg, const size_t n) noexcept
+			{
+				const auto wk{_mm256_add_epi64(msg, load256(k.data() + n))};
+				cdgh = _mm256_sha512rnds2_epi64(cdgh, abef, _mm256_castsi256_si128(wk));
+				abef = _mm256_sha512rnds2_epi64(abef, cdgh, _mm256_extracti128_si256(wk, 1));
+			}
+
+			// Computes message words W[n + 16] through W[n + 19] from the previous 16
+			SUBSTRATE_TARGET("sha512,avx2") inline __m256i expandSHA512(const __m256i msg0, const __m256i msg1,
+				const __m256i msg2, const __m256i msg3) noexcept
+			{
+				const auto words{_mm256_add_epi64(_mm256_sha512msg1_epi64(msg0, _mm256_castsi256_si128(msg1)),
+					alignWords(msg3, msg2))};
+				return _mm256_sha512msg2_epi64(words, msg3);
+			}
+
+			SUBSTRATE_TARGET("sha512,avx2") void sha512NI(std::array<uint64_t, 8> &state, const uint8_t *data,
+				size_t blocks) noexcept
+			{
+				const auto byteSwap{_mm256_set_epi64x(0x08090A0B0C0D0E0F, 0x0001020304050607,
+					0x08090A0B0C0D0E0F, 0x0001020304050607)};
+				// Rearrange {A, B, C, D}, {E, F, G, H} into the {F, E, B, A}, {H, G, D, C} lane order
+				const auto dcba{load256(state.data())};
+				const auto hgfe{load256(state.data() + 4)};
+				auto abef{_mm256_permute4x64_epi64(_mm256_permute2x128_si256(hgfe, dcba, 0x20), 0xB1)};
+				auto cdgh{_mm256_permute4x64_epi64(_mm256_permute2x128_si256(hgfe, dcba, 0x31), 0xB1)};
+
+				for (; blocks; --blocks, data += sha512_t::blockSize)
+				{
+					const auto abefSaved{abef};
+					const auto cdghSaved{cdgh};
+
+					auto msg0{_mm256_shuffle_epi8(load256(data), byteSwap)};
+					auto msg1{_mm256_shuffle_epi8(load256(data + 32), byteSwap)};
+					auto msg2{_mm256_shuffle_epi8(load256(data + 64), byteSwap)};
+					auto msg3{_mm256_shuffle_epi8(load256(data + 96), byteSwap)};
+
+					quadRoundSHA512(abef, cdgh, msg0, 0U);
+					quadRoundSHA512(abef, cdgh, msg1, 4U);
+					quadRoundSHA512(abef, cdgh, msg2, 8U);
+					quadRoundSHA512(abef, cdgh, msg3, 12U);
+					for (size_t n{16U}; n < k.size(); n += 16U)
+					{
+						msg0 = expandSHA512(msg0, msg1, msg2, msg3);
+						quadRoundSHA512(abef, cdgh, msg0, n);
+						msg1 = expandSHA512(msg1, msg2, msg3, msg0);
+						quadRoundSHA512(abef, cdgh, msg1, n + 4U);
+						msg2 = expandSHA512(msg2, msg3, msg0, msg1);
+						quadRoundSHA512(abef, cdgh, msg2, n + 8U);
+						msg3 = expandSHA512(msg3, msg0, msg1, msg2);
+						quadRoundSHA512(abef, cdgh, msg3, n + 12U);
+					}
+
+					abef = _mm256_add_epi64(abef, abefSaved);
+					cdgh = _mm256_add_epi64(cdgh, cdghSaved);
+				}
+
+				store256(state.data(), _mm256_permute4x64_epi64(_mm256_permute2x128_si256(abef, cdgh, 0x31), 0xB1));
+				store256(state.data() + 4, _mm256_permute4x64_epi64(_mm256_permute2x128_si256(abef, cdgh, 0x20), 0xB1));
+			}
+#endif
+
+#if defined(SUBSTRATE_SHA512_ARMV8)
+			inline uint64x2_t loadBE(const uint8_t *const data) noexcept
+				{ return vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(data))); }
+
+			/*
+			 * Performs 2 rounds with the ARMv8.2 SHA512 instructions. The state lives in {A, B}, {C, D},
+			 * {E, F}, {G, H} pairs which shift along by one pair every call.
+			 */
+			SUBSTRATE_TARGET("+sha3") inline void doubleRoundARMv8(uint64x2_t &ab, uint64x2_t &cd, uint64x2_t &ef, uint64x2_t &gh,
+				const uint64x2_t msg, const size_t n) noexcept
+			{
+				auto wk{vaddq_u64(msg, vld1q_u64(k.data() + n))};
+				wk = vextq_u64(wk, wk, 1);
+				const auto fg{vextq_u64(ef, gh, 1)};
+				const auto de{vextq_u64(cd, ef, 1)};
+				const auto sum{vsha512hq_u64(vaddq_u64(gh, wk), fg, de)};
+				const auto newEF{vaddq_u64(cd, sum)};
+				const auto newAB{vsha512h2q_u64(sum, cd, ab)};
+				gh = ef;
+				ef = newEF;
+				cd = ab;
+				ab = newAB;
+			}
+
+			SUBSTRATE_TARGET("+sha3") void sha512ARMv8(std::array<uint64_t, 8> &state, const uint8_t *data, size_t blocks) noexcept
+			{
+				auto ab{vld1q_u64(state.data())};
+				auto cd{vld1q_u64(state.data() + 2)};
+				auto ef{vld1q_u64(state.data() + 4)};
+				auto gh{vld1q_u64(state.data() + 6)};
+
+				// NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+				uint64x2_t msg[8];
+				for (; blocks; --blocks, data += sha512_t::blockSize)
+				{
+					const auto abSaved{ab};
+					const auto cdSaved{cd};
+					const auto efSaved{ef};
+					const auto ghSaved{gh};
+
+					for (size_t i{}; i < 8U; ++i)
+						msg[i] = loadBE(data + (i * 16U));
+
+					for (size_t i{}; i < 40U; ++i)
+					{
+						const auto current{msg[i & 7U]};
+						// Computes W[2i + 16] and W[2i + 17] while W[2i] and W[2i + 1] are consumed
+						if (i < 32U)
+							msg[i & 7U] = vsha512su1q_u64(vsha512su0q_u64(current, msg[(i + 1U) & 7U]),
+								msg[(i + 7U) & 7U], vextq_u64(msg[(i + 4U) & 7U], msg[(i + 5U) & 7U], 1));
+						doubleRoundARMv8(ab, cd, ef, gh, current, i * 2U);
+					}
+
+					ab = vaddq_u64(ab, abSaved);
+					cd = vaddq_u64(cd, cdSaved);
+					ef = vaddq_u64(ef, efSaved);
+					gh = vaddq_u64(gh, ghSaved);
+				}
+
+				vst1q_u64(state.data(), ab);
+				vst1q_u64(state.data() + 2, cd);
+				vst1q_u64(state.data() + 4, ef);
+				vst1q_u64(state.data() + 6, gh);
+			}
+#endif
+		} // namespace
+	} // namespace crypto
+
+	namespace internal
+	{
+		kernels_t<sha512Kernel_t> sha512Kernels() noexcept
+		{
+			SUBSTRATE_NOWARN_UNUSED(const auto &features){cpuFeatures()};
+			kernels_t<sha512Kernel_t> kernels{};
+#if defined(SUBSTRATE_SHA512_NI)
+			if (features.sha512 && features.avx2)
+				kernels.add("SHA512", crypto::sha512NI);
+#endif
+#if defined(SUBSTRATE_SHA512_ARMV8)
+			if (features.sha512)
+				kernels.add("ARMv8.2", crypto::sha512ARMv8);
+#endif
+			kernels.add("scalar", crypto::sha512Scalar);
+			return kernels;
+		}
+
+		void sha512Blocks(std::array<uint64_t, 8> &state, const uint8_t *const data, const size_t blocks) noexcept
+		{
+			static const auto kernel{sha512Kernels().front().function};
+			if (!data || !blocks)
+				return;
+			kernel(state, data, blocks);
+		}
+	} // namespace internal
+} // namespace substrate
@@ -5,6 +5,9 @@
 #define _CRT_USE_BUILTIN_OFFSETOF
 #endif
 
+#include <algorithm>
+#include <array>
+#include <climits>
 #include <cstring>
 
 #ifdef _WIN32
@@ -20,6 +23,7 @@
 
 #include <substrate/utility>
 #include <substrate/socket>
+#include <substrate/internal/fd_compat>
 
 #ifndef _WIN32
 using substrate::INVALID_SOCKET;
@@ -61,11 +65,50 @@ ssize_t socket_t::write(const void *const bufferPtr, const size_t len) const noe
 	{ return ::write(socket, bufferPtr, len); }
 ssize_t socket_t::read(void *const bufferPtr, const size_t len) const noexcept
 	{ return ::read(socket, bufferPtr, len); }
+ssize_t socket_t::writeVec(const writeBuffers_t buffers, std::nullptr_t) const noexcept
+	{ return internal::fdwritev(socket, buffers); }
+ssize_t socket_t::readVec(const readBuffers_t buffers, std::nullptr_t) const noexcept
+	{ return internal::fdreadv(socket, buffers); }
 #else
 ssize_t socket_t::write(const void *const bufferPtr, const size_t len) const noexcept
 	{ return ::send(socket, static_cast<const char *>(bufferPtr), int32_t(len), 0); }
 ssize_t socket_t::read(void *const bufferPtr, const size_t len) const noexcept
 	{ return ::recv(socket, static_cast<char *>(bufferPtr), int32_t(len), 0); }
+
+template<typename T> inline DWORD toWSABufs(const span<const span<T>> buffers, std::array<WSABUF, 64> &vecs) noexcept
+{
+	DWORD count{};
+	for (const auto &buffer : buffers)
+	{
+		if (count == vecs.size())
+			break;
+		if (buffer.empty())
+			continue;
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+		vecs[count].buf = const_cast<char *>(reinterpret_cast<const char *>(buffer.data()));
+		vecs[count++].len = ULONG(std::min<size_t>(buffer.size(), ULONG_MAX));
+	}
+	return count;
+}
+
+ssize_t socket_t::writeVec(const writeBuffers_t buffers, std::nullptr_t) const noexcept
+{
+	std::array<WSABUF, 64> vecs{};
+	DWORD sent{};
+	if (WSASend(socket, vecs.data(), toWSABufs(buffers, vecs), &sent, 0, nullptr, nullptr) != 0)
+		return -1;
+	return ssize_t(sent);
+}
+
+ssize_t socket_t::readVec(const readBuffers_t buffers, std::nullptr_t) const noexcept
+{
+	std::array<WSABUF, 64> vecs{};
+	DWORD received{};
+	DWORD flags{};
+	if (WSARecv(socket, vecs.data(), toWSABufs(buffers, vecs), &received, &flags, nullptr, nullptr) != 0)
+		return -1;
+	return ssize_t(received);
+}
 #endif
 
 ssize_t socket_t::writeto(void *const bufferPtr, const size_t len, const sockaddr_storage &addr) const noexcept
@@ -0,0 +1,715 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "substrate/hash"
+#include "substrate/internal/cpu_features"
+
+#if defined(SUBSTRATE_ARCH_X86)
+#	include <immintrin.h>
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+#	include <arm_neon.h>
+#endif
+
+#if __cplusplus < 201703L
+constexpr size_t substrate::xxh3_t::secretLength;
+constexpr size_t substrate::xxh3_t::bufferLength;
+#endif
+
+/*
+ * XXH3, as specified by xxHash 0.8. Inputs up to 240 bytes take one of the short, fully unrolled
+ * paths; longer inputs run eight 64-bit accumulators over 64-byte stripes, which is the part that
+ * gets vectorised, with a scramble of the accumulators every 1KiB block.
+ */
+
+namespace substrate
+{
+	namespace internal
+	{
+		namespace
+		{
+			constexpr uint64_t prime32_1{UINT32_C(0x9E3779B1)};
+			constexpr uint64_t prime32_2{UINT32_C(0x85EBCA77)};
+			constexpr uint64_t prime32_3{UINT32_C(0xC2B2AE3D)};
+			constexpr uint64_t prime64_1{UINT64_C(0x9E3779B185EBCA87)};
+			constexpr uint64_t prime64_2{UINT64_C(0xC2B2AE3D27D4EB4F)};
+			constexpr uint64_t prime64_3{UINT64_C(0x165667B19E3779F9)};
+			constexpr uint64_t prime64_4{UINT64_C(0x85EBCA77C2B2AE63)};
+			constexpr uint64_t prime64_5{UINT64_C(0x27D4EB2F165667C5)};
+			constexpr uint64_t primeMX1{UINT64_C(0x165667919E3779F9)};
+			constexpr uint64_t primeMX2{UINT64_C(0x9FB21C651E98DF25)};
+
+			constexpr size_t stripeLength{64U};
+			constexpr size_t secretConsumeRate{8U};
+			constexpr size_t stripesPerBlock{(xxh3_t::secretLength - stripeLength) / secretConsumeRate};
+			constexpr size_t blockLength{stripeLength * stripesPerBlock};
+			constexpr size_t secretLimit{xxh3_t::secretLength - stripeLength};
+			constexpr size_t lastStripeOffset{7U};
+			constexpr size_t mergeAccsOffset{11U};
+			constexpr size_t midsizeOffset{3U};
+			constexpr size_t midsizeLastOffset{17U};
+			constexpr size_t secretSizeMin{136U};
+			constexpr size_t midsizeMax{240U};
+
+			using secret_t = std::array<uint8_t, xxh3_t::secretLength>;
+			using acc_t = std::array<uint64_t, 8>;
+
+			constexpr secret_t defaultSecret
+			{{
+				0xB8, 0xFE, 0x6C, 0x39, 0x23, 0xA4, 0x4B, 0xBE, 0x7C, 0x01, 0x81, 0x2C, 0xF7, 0x21, 0xAD, 0x1C,
+				0xDE, 0xD4, 0x6D, 0xE9, 0x83, 0x90, 0x97, 0xDB, 0x72, 0x40, 0xA4, 0xA4, 0xB7, 0xB3, 0x67, 0x1F,
+				0xCB, 0x79, 0xE6, 0x4E, 0xCC, 0xC0, 0xE5, 0x78, 0x82, 0x5A, 0xD0, 0x7D, 0xCC, 0xFF, 0x72, 0x21,
+				0xB8, 0x08, 0x46, 0x74, 0xF7, 0x43, 0x24, 0x8E, 0xE0, 0x35, 0x90, 0xE6, 0x81, 0x3A, 0x26, 0x4C,
+				0x3C, 0x28, 0x52, 0xBB, 0x91, 0xC3, 0x00, 0xCB, 0x88, 0xD0, 0x65, 0x8B, 0x1B, 0x53, 0x2E, 0xA3,
+				0x71, 0x64, 0x48, 0x97, 0xA2, 0x0D, 0xF9, 0x4E, 0x38, 0x19, 0xEF, 0x46, 0xA9, 0xDE, 0xAC, 0xD8,
+				0xA8, 0xFA, 0x76, 0x3F, 0xE3, 0x9C, 0x34, 0x3F, 0xF9, 0xDC, 0xBB, 0xC7, 0xC7, 0x0B, 0x4F, 0x1D,
+				0x8A, 0x51, 0xE0, 0x4B, 0xCD, 0xB4, 0x59, 0x31, 0xC8, 0x9F, 0x7E, 0xC9, 0xD9, 0x78, 0x73, 0x64,
+				0xEA, 0xC5, 0xAC, 0x83, 0x34, 0xD3, 0xEB, 0xC3, 0xC5, 0x81, 0xA0, 0xFF, 0xFA, 0x13, 0x63, 0xEB,
+				0x17, 0x0D, 0xDD, 0x51, 0xB7, 0xF0, 0xDA, 0x49, 0xD3, 0x16, 0x55, 0x26, 0x29, 0xD4, 0x68, 0x9E,
+				0x2B, 0x16, 0xBE, 0x58, 0x7D, 0x47, 0xA1, 0xFC, 0x8F, 0xF8, 0xB8, 0xD1, 0x7A, 0xD0, 0x31, 0xCE,
+				0x45, 0xCB, 0x3A, 0x8F, 0x95, 0x16, 0x04, 0x28, 0xAF, 0xD7, 0xFB, 0xCA, 0xBB, 0x4B, 0x40, 0x7E,
+			}};
+
+			constexpr acc_t initialAcc{{prime32_3, prime64_1, prime64_2, prime64_3, prime64_4, prime32_2,
+				prime64_5, prime32_1}};
+
+			struct uint128_t final
+			{
+				uint64_t low;
+				uint64_t high;
+			};
+
+			inline uint64_t read64(const uint8_t *const data) noexcept
+			{
+				uint64_t value{};
+				std::memcpy(&value, data, sizeof(value));
+				return value;
+			}
+
+			inline uint32_t read32(const uint8_t *const data) noexcept
+			{
+				uint32_t value{};
+				std::memcpy(&value, data, sizeof(value));
+				return value;
+			}
+
+			inline void write64(uint8_t *const data, const uint64_t value) noexcept
+				{ std::memcpy(data, &value, sizeof(value)); }
+
+			inline uint32_t swap32(const uint32_t value) noexcept
+			{
+				return ((value << 24U) & 0xFF000000U) | ((value << 8U) & 0x00FF0000U) |
+					((value >> 8U) & 0x0000FF00U) | ((value >> 24U) & 0x000000FFU);
+			}
+
+			inline uint64_t swap64(const uint64_t value) noexcept
+				{ return (uint64_t{swap32(uint32_t(value))} << 32U) | swap32(uint32_t(value >> 32U)); }
+
+			inline uint128_t mult64to128(const uint64_t a, const uint64_t b) noexcept
+			{
+#if defined(__SIZEOF_INT128__)
+				__extension__ using u128_t = unsigned __int128;
+				const auto product{u128_t{a} * b};
+				return {uint64_t(product), uint64_t(product >> 64U)};
+#else
+				const uint64_t loLo{(a & 0xFFFFFFFFU) * (b & 0xFFFFFFFFU)};
+				const uint64_t hiLo{(a >> 32U) * (b & 0xFFFFFFFFU)};
+				const uint64_t loHi{(a & 0xFFFFFFFFU) * (b >> 32U)};
+				const uint64_t hiHi{(a >> 32U) * (b >> 32U)};
+				const uint64_t cross{(loLo >> 32U) + (hiLo & 0xFFFFFFFFU) + loHi};
+				return {(cross << 32U) | (loLo & 0xFFFFFFFFU), (hiLo >> 32U) + (cross >> 32U) + hiHi};
+#endif
+			}
+
+			inline uint64_t mul128Fold64(const uint64_t a, const uint64_t b) noexcept
+			{
+				const auto product{mult64to128(a, b)};
+				return product.low ^ product.high;
+			}
+
+			inline uint64_t xxh64Avalanche(uint64_t hash) noexcept
+			{
+				hash ^= hash >> 33U;
+				hash *= prime64_2;
+				hash ^= hash >> 29U;
+				hash *= prime64_3;
+				hash ^= hash >> 32U;
+				return hash;
+			}
+
+			inline uint64_t avalanche(uint64_t hash) noexcept
+			{
+				hash ^= hash >> 37U;
+				hash *= primeMX1;
+				hash ^= hash >> 32U;
+				return hash;
+			}
+
+			inline uint64_t rrmxmx(uint64_t hash, const uint64_t length) noexcept
+			{
+				hash ^= rotl(hash, 49U) ^ rotl(hash, 24U);
+				hash *= primeMX2;
+				hash ^= (hash >> 35U) + length;
+				hash *= primeMX2;
+				hash ^= hash >> 28U;
+				return hash;
+			}
+
+			inline uint64_t mix16B(const uint8_t *const data, const uint8_t *const secret, const uint64_t seed) noexcept
+			{
+				return mul128Fold64(read64(data) ^ (read64(secret) + seed),
+					read64(data + 8) ^ (read64(secret + 8) - seed));
+			}
+
+			inline uint128_t mix32B(uint128_t acc, const uint8_t *const dataA, const uint8_t *const dataB,
+				const uint8_t *const secret, const uint64_t seed) noexcept
+			{
+				acc.low += mix16B(dataA, secret, seed);
+				acc.low ^= read64(dataB) + read64(dataB + 8);
+				acc.high += mix16B(dataB, secret + 16, seed);
+				acc.high ^= read64(dataA) + read64(dataA + 8);
+				return acc;
+			}
+
+			/* Stripe accumulation and scrambling kernels */
+			using accumulateKernel_t = void (*)(acc_t &, const uint8_t *, const uint8_t *, size_t) noexcept;
+			using scrambleKernel_t = void (*)(acc_t &, const uint8_t *) noexcept;
+
+			void accumulateScalar(acc_t &acc, const uint8_t *data, const uint8_t *secret, const size_t stripes) noexcept
+			{
+				for (size_t stripe{}; stripe < stripes; ++stripe)
+				{
+					for (size_t i{}; i < acc.size(); ++i)
+					{
+						const auto value{read64(data + (i * 8U))};
+						const auto key{value ^ read64(secret + (i * 8U))};
+						acc[i ^ 1U] += value;
+						acc[i] += (key & 0xFFFFFFFFU) * (key >> 32U);
+					}
+					data += stripeLength;
+					secret += secretConsumeRate;
+				}
+			}
+
+			void scrambleScalar(acc_t &acc, const uint8_t *const secret) noexcept
+			{
+				for (size_t i{}; i < acc.size(); ++i)
+				{
+					auto value{acc[i]};
+					value ^= value >> 47U;
+					value ^= read64(secret + (i * 8U));
+					acc[i] = value * prime32_1;
+				}
+			}
+
+#if defined(SUBSTRATE_ARCH_X86)
+			inline __m128i load128(const void *const data) noexcept
+			{
+				__m128i value{};
+				std::memcpy(&value, data, sizeof(value));
+				return value;
+			}
+
+			inline void store128(void *const data, const __m128i value) noexcept
+				{ std::memcpy(data, &value, sizeof(value)); }
+
+			void accumulateSSE2(acc_t &acc, const uint8_t *data, const uint8_t *secret, const size_t stripes) noexcept
+			{
+				// NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+				__m128i accs[4];
+				for (size_t i{}; i < 4U; ++i)
+					accs[i] = load128(&acc[i * 2U]);
+				for (size_t stripe{}; stripe < stripes; ++stripe)
+				{
+					for (size_t i{}; i < 4U; ++i)
+					{
+						const auto value{load128(data + (i * 16U))};
+						const auto key{_mm_xor_si128(value, load128(secret + (i * 16U)))};
+						const auto product{_mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)))};
+						const auto swapped{_mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2))};
+						accs[i] = _mm_add_epi64(product, _mm_add_epi64(accs[i], swapped));
+					}
+					data += stripeLength;
+					secret += secretConsumeRate;
+				}
+				for (size_t i{}; i < 4U; ++i)
+					store128(&acc[i * 2U], accs[i]);
+			}
+
+			void scrambleSSE2(acc_t &acc, const uint8_t *const secret) noexcept
+			{
+				const auto prime{_mm_set1_epi32(int32_t(prime32_1))};
+				for (size_t i{}; i < 4U; ++i)
+				{
+					auto value{load128(&acc[i * 2U])};
+					value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+					const auto key{_mm_xor_si128(value, load128(secret + (i * 16U)))};
+					const auto keyHigh{_mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1))};
+					const auto productLow{_mm_mul_epu32(key, prime)};
+					const auto productHigh{_mm_mul_epu32(keyHigh, prime)};
+					store128(&acc[i * 2U], _mm_add_epi64(productLow, _mm_slli_epi64(productHigh, 32)));
+				}
+			}
+
+			SUBSTRATE_TARGET("avx2") inline __m256i load256(const void *const data) noexcept
+			{
+				__m256i value{};
+				std::memcpy(&value, data, sizeof(value));
+				return value;
+			}
+
+			SUBSTRATE_TARGET("avx2") inline void store256(void *const data, const __m256i value) noexcept
+				{ std::memcpy(data, &value, sizeof(value)); }
+
+			SUBSTRATE_TARGET("avx2") void accumulateAVX2(acc_t &acc, const uint8_t *data, const uint8_t *secret,
+				const size_t stripes) noexcept
+			{
+				auto accLow{load256(&acc[0])};
+				auto accHigh{load256(&acc[4])};
+				for (size_t stripe{}; stripe < stripes; ++stripe)
+				{
+					const auto valueLow{load256(data)};
+					const auto valueHigh{load256(data + 32)};
+					const auto keyLow{_mm256_xor_si256(valueLow, load256(secret))};
+					const auto keyHigh{_mm256_xor_si256(valueHigh, load256(secret + 32))};
+					const auto productLow{_mm256_mul_epu32(keyLow, _mm256_srli_epi64(keyLow, 32))};
+					const auto productHigh{_mm256_mul_epu32(keyHigh, _mm256_srli_epi64(keyHigh, 32))};
+					accLow = _mm256_add_epi64(productLow,
+						_mm256_add_epi64(accLow, _mm256_shuffle_epi32(valueLow, _MM_SHUFFLE(1, 0, 3, 2))));
+					accHigh = _mm256_add_epi64(productHigh,
+						_mm256_add_epi64(accHigh, _mm256_shuffle_epi32(valueHigh, _MM_SHUFFLE(1, 0, 3, 2))));
+					data += stripeLength;
+					secret += secretConsumeRate;
+				}
+				store256(&acc[0], accLow);
+				store256(&acc[4], accHigh);
+			}
+
+			SUBSTRATE_TARGET("avx2") void scrambleAVX2(acc_t &acc, const uint8_t *const secret) noexcept
+			{
+				const auto prime{_mm256_set1_epi32(int32_t(prime32_1))};
+				for (size_t i{}; i < 2U; ++i)
+				{
+					auto value{load256(&acc[i * 4U])};
+					value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 47));
+					const auto key{_mm256_xor_si256(value, load256(secret + (i * 32U)))};
+					const auto productLow{_mm256_mul_epu32(key, prime)};
+					const auto productHigh{_mm256_mul_epu32(_mm256_srli_epi64(key, 32), prime)};
+					store256(&acc[i * 4U], _mm256_add_epi64(productLow, _mm256_slli_epi64(productHigh, 32)));
+				}
+			}
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+			void accumulateNEON(acc_t &acc, const uint8_t *data, const uint8_t *secret, const size_t stripes) noexcept
+			{
+				// NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+				uint64x2_t accs[4];
+				for (size_t i{}; i < 4U; ++i)
+					accs[i] = vld1q_u64(&acc[i * 2U]);
+				for (size_t stripe{}; stripe < stripes; ++stripe)
+				{
+					for (size_t i{}; i < 4U; ++i)
+					{
+						const auto value{vreinterpretq_u64_u8(vld1q_u8(data + (i * 16U)))};
+						const auto key{veorq_u64(value, vreinterpretq_u64_u8(vld1q_u8(secret + (i * 16U))))};
+						const auto sum{vaddq_u64(accs[i], vextq_u64(value, value, 1))};
+						accs[i] = vmlal_u32(sum, vmovn_u64(key), vshrn_n_u64(key, 32));
+					}
+					data += stripeLength;
+					secret += secretConsumeRate;
+				}
+				for (size_t i{}; i < 4U; ++i)
+					vst1q_u64(&acc[i * 2U], accs[i]);
+			}
+
+			void scrambleNEON(acc_t &acc, const uint8_t *const secret) noexcept
+			{
+				const auto prime{vdup_n_u32(uint32_t(prime32_1))};
+				for (size_t i{}; i < 4U; ++i)
+				{
+					auto value{vld1q_u64(&acc[i * 2U])};
+					value = veorq_u64(value, vshrq_n_u64(value, 47));
+					const auto key{veorq_u64(value, vreinterpretq_u64_u8(vld1q_u8(secret + (i * 16U))))};
+					const auto productHigh{vshlq_n_u64(vmull_u32(vshrn_n_u64(key, 32), prime), 32)};
+					vst1q_u64(&acc[i * 2U], vmlal_u32(productHigh, vmovn_u64(key), prime));
+				}
+			}
+#endif
+
+			struct stripeKernels_t final
+			{
+				accumulateKernel_t accumulate;
+				scrambleKernel_t scramble;
+			};
+
+			stripeKernels_t selectStripeKernels() noexcept
+			{
+#if defined(SUBSTRATE_ARCH_X86)
+				if (cpuFeatures().avx2)
+					return {accumulateAVX2, scrambleAVX2};
+#	if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+				return {accumulateSSE2, scrambleSSE2};
+#	endif
+#elif defined(SUBSTRATE_ARCH_AARCH64)
+				return {accumulateNEON, scrambleNEON};
+#endif
+				return {accumulateScalar, scrambleScalar};
+			}
+
+			const stripeKernels_t &stripeKernels() noexcept
+			{
+				static const stripeKernels_t kernels{selectStripeKernels()};
+				return kernels;
+			}
+
+			void deriveSecret(secret_t &secret, const uint64_t seed) noexcept
+			{
+				for (size_t i{}; i < secret.size(); i += 16U)
+				{
+					write64(secret.data() + i, read64(defaultSecret.data() + i) + seed);
+					write64(secret.data() + i + 8U, read64(defaultSecret.data() + i + 8U) - seed);
+				}
+			}
+
+			/* Consumes stripes for a stream, scrambling as we cross the block boundary */
+			void consumeStripes(acc_t &acc, size_t &stripesSoFar, const uint8_t *const data, const size_t stripes,
+				const uint8_t *const secret) noexcept
+			{
+				const auto &kernels{stripeKernels()};
+				if (stripesPerBlock - stripesSoFar <= stripes)
+				{
+					const auto stripesToEnd{stripesPerBlock - stripesSoFar};
+					kernels.accumulate(acc, data, secret + (stripesSoFar * secretConsumeRate), stripesToEnd);
+					kernels.scramble(acc, secret + secretLimit);
+					kernels.accumulate(acc, data + (stripesToEnd * stripeLength), secret, stripes - stripesToEnd);
+					stripesSoFar = stripes - stripesToEnd;
+				}
+				else
+				{
+					kernels.accumulate(acc, data, secret + (stripesSoFar * secretConsumeRate), stripes);
+					stripesSoFar += stripes;
+				}
+			}
+
+			void hashLong(acc_t &acc, const uint8_t *const data, const size_t dataLen, const uint8_t *const secret) noexcept
+			{
+				const auto &kernels{stripeKernels()};
+				const auto blocks{(dataLen - 1U) / blockLength};
+				for (size_t block{}; block < blocks; ++block)
+				{
+					kernels.accumulate(acc, data + (block * blockLength), secret, stripesPerBlock);
+					kernels.scramble(acc, secret + secretLimit);
+				}
+
+				const auto stripes{((dataLen - 1U) - (blocks * blockLength)) / stripeLength};
+				kernels.accumulate(acc, data + (blocks * blockLength), secret, stripes);
+				kernels.accumulate(acc, data + dataLen - stripeLength, secret + secretLimit - lastStripeOffset, 1U);
+			}
+
+			uint64_t mergeAccs(const acc_t &acc, const uint8_t *const secret, const uint64_t start) noexcept
+			{
+				uint64_t result{start};
+				for (size_t i{}; i < 4U; ++i)
+				{
+					result += mul128Fold64(acc[i * 2U] ^ read64(secret + (i * 16U)),
+						acc[(i * 2U) + 1U] ^ read64(secret + (i * 16U) + 8U));
+				}
+				return avalanche(result);
+			}
+
+			uint64_t merge64(const acc_t &acc, const uint8_t *const secret, const uint64_t length) noexcept
+				{ return mergeAccs(acc, secret + mergeAccsOffset, length * prime64_1); }
+
+			std::pair<uint64_t, uint64_t> merge128(const acc_t &acc, const uint8_t *const secret,
+				const uint64_t length) noexcept
+			{
+				return
+				{
+					mergeAccs(acc, secret + mergeAccsOffset, length * prime64_1),
+					mergeAccs(acc, secret + xxh3_t::secretLength - stripeLength - mergeAccsOffset, ~(length * prime64_2))
+				};
+			}
+
+			uint64_t hash64Short(const uint8_t *const data, const size_t dataLen, const uint64_t seed) noexcept
+			{
+				const auto *const secret{defaultSecret.data()};
+				const uint64_t length{dataLen};
+				if (dataLen > 16U)
+				{
+					uint64_t acc{length * prime64_1};
+					if (dataLen > 128U)
+					{
+						const auto rounds{dataLen / 16U};
+						for (size_t i{}; i < 8U; ++i)
+							acc += mix16B(data + (16U * i), secret + (16U * i), seed);
+						acc = avalanche(acc);
+						for (size_t i{8U}; i < rounds; ++i)
+							acc += mix16B(data + (16U * i), secret + (16U * (i - 8U)) + midsizeOffset, seed);
+						acc += mix16B(data + dataLen - 16U, secret + secretSizeMin - midsizeLastOffset, seed);
+						return avalanche(acc);
+					}
+					if (dataLen > 32U)
+					{
+						if (dataLen > 64U)
+						{
+							if (dataLen > 96U)
+							{
+								acc += mix16B(data + 48, secret + 96, seed);
+								acc += mix16B(data + dataLen - 64U, secret + 112, seed);
+							}
+							acc += mix16B(data + 32, secret + 64, seed);
+							acc += mix16B(data + dataLen - 48U, secret + 80, seed);
+						}
+						acc += mix16B(data + 16, secret + 32, seed);
+						acc += mix16B(data + dataLen - 32U, secret + 48, seed);
+					}
+					acc += mix16B(data, secret, seed);
+					acc += mix16B(data + dataLen - 16U, secret + 16, seed);
+					return avalanche(acc);
+				}
+				if (dataLen > 8U)
+				{
+					const auto flipLow{(read64(secret + 24) ^ read64(secret + 32)) + seed};
+					const auto flipHigh{(read64(secret + 40) ^ read64(secret + 48)) - seed};
+					const auto low{read64(data) ^ flipLow};
+					const auto high{read64(data + dataLen - 8U) ^ flipHigh};
+					return avalanche(length + swap64(low) + high + mul128Fold64(low, high));
+				}
+				if (dataLen >= 4U)
+				{
+					const auto keyedSeed{seed ^ (uint64_t{swap32(uint32_t(seed))} << 32U)};
+					const auto flip{(read64(secret + 8) ^ read64(secret + 16)) - keyedSeed};
+					const auto value{read32(data + dataLen - 4U) + (uint64_t{read32(data)} << 32U)};
+					return rrmxmx(value ^ flip, length);
+				}
+				if (dataLen)
+				{
+					const uint32_t combined{(uint32_t{data[0]} << 16U) | (uint32_t{data[dataLen >> 1U]} << 24U) |
+						uint32_t{data[dataLen - 1U]} | (uint32_t(dataLen) << 8U)};
+					const auto flip{uint64_t{read32(secret) ^ read32(secret + 4)} + seed};
+					return xxh64Avalanche(combined ^ flip);
+				}
+				return xxh64Avalanche(seed ^ read64(secret + 56) ^ read64(secret + 64));
+			}
+
+			std::pair<uint64_t, uint64_t> finish128(const uint128_t acc, const uint64_t length, const uint64_t seed) noexcept
+			{
+				const auto low{acc.low + acc.high};
+				const auto high{(acc.low * prime64_1) + (acc.high * prime64_4) + ((length - seed) * prime64_2)};
+				return {avalanche(low), 0U - avalanche(high)};
+			}
+
+			std::pair<uint64_t, uint64_t> hash128Short(const uint8_t *const data, const size_t dataLen,
+				const uint64_t seed) noexcept
+			{
+				const auto *const secret{defaultSecret.data()};
+				const uint64_t length{dataLen};
+				if (dataLen > 16U)
+				{
+					uint128_t acc{length * prime64_1, 0U};
+					if (dataLen > 128U)
+					{
+						for (size_t i{}; i < 4U; ++i)
+							acc = mix32B(acc, data + (32U * i), data + (32U * i) + 16U, secret + (32U * i), seed);
+						acc.low = avalanche(acc.low);
+						acc.high = avalanche(acc.high);
+						const auto rounds{dataLen / 32U};
+						for (size_t i{4U}; i < rounds; ++i)
+						{
+							acc = mix32B(acc, data + (32U * i), data + (32U * i) + 16U,
+								secret + midsizeOffset + (32U * (i - 4U)), seed);
+						}
+						acc = mix32B(acc, data + dataLen - 16U, data + dataLen - 32U,
+							secret + secretSizeMin - midsizeLastOffset - 16U, 0U - seed);
+						return finish128(acc, length, seed);
+					}
+					if (dataLen > 32U)
+					{
+						if (dataLen > 64U)
+						{
+							if (dataLen > 96U)
+								acc = mix32B(acc, data + 48, data + dataLen - 64U, secret + 96, seed);
+							acc = mix32B(acc, data + 32, data + dataLen - 48U, secret + 64, seed);
+						}
+						acc = mix32B(acc, data + 16, data + dataLen - 32U, secret + 32, seed);
+					}
+					acc = mix32B(acc, data, data + dataLen - 16U, secret, seed);
+					return finish128(acc, length, seed);
+				}
+				if (dataLen > 8U)
+				{
+					const auto flipLow{(read64(secret + 32) ^ read64(secret + 40)) - seed};
+					const auto flipHigh{(read64(secret + 48) ^ read64(secret + 56)) + seed};
+					const auto low{read64(data)};
+					auto high{read64(data + dataLen - 8U)};
+					auto mixed{mult64to128(low ^ high ^ flipLow, prime64_1)};
+					mixed.low += (length - 1U) << 54U;
+					high ^= flipHigh;
+					mixed.high += high + ((high & 0xFFFFFFFFU) * (prime32_2 - 1U));
+					mixed.low ^= swap64(mixed.high);
+					auto result{mult64to128(mixed.low, prime64_2)};
+					result.high += mixed.high * prime64_2;
+					return {avalanche(result.low), avalanche(result.high)};
+				}
+				if (dataLen >= 4U)
+				{
+					const auto keyedSeed{seed ^ (uint64_t{swap32(uint32_t(seed))} << 32U)};
+					const auto value{read32(data) + (uint64_t{read32(data + dataLen - 4U)} << 32U)};
+					const auto flip{(read64(secret + 16) ^ read64(secret + 24)) + keyedSeed};
+					auto mixed{mult64to128(value ^ flip, prime64_1 + (length << 2U))};
+					mixed.high += mixed.low << 1U;
+					mixed.low ^= mixed.high >> 3U;
+					mixed.low ^= mixed.low >> 35U;
+					mixed.low *= primeMX2;
+					mixed.low ^= mixed.low >> 28U;
+					return {mixed.low, avalanche(mixed.high)};
+				}
+				if (dataLen)
+				{
+					const uint32_t combinedLow{(uint32_t{data[0]} << 16U) | (uint32_t{data[dataLen >> 1U]} << 24U) |
+						uint32_t{data[dataLen - 1U]} | (uint32_t(dataLen) << 8U)};
+					const uint32_t combinedHigh{rotl(swap32(combinedLow), 13U)};
+					const auto flipLow{uint64_t{read32(secret) ^ read32(secret + 4)} + seed};
+					const auto flipHigh{uint64_t{read32(secret + 8) ^ read32(secret + 12)} - seed};
+					return {xxh64Avalanche(combinedLow ^ flipLow), xxh64Avalanche(combinedHigh ^ flipHigh)};
+				}
+				return
+				{
+					xxh64Avalanche(seed ^ read64(secret + 64) ^ read64(secret + 72)),
+					xxh64Avalanche(seed ^ read64(secret + 80) ^ read64(secret + 88))
+				};
+			}
+
+			const uint8_t *longSecret(secret_t &storage, const uint64_t seed) noexcept
+			{
+				if (!seed)
+					return defaultSecret.data();
+				deriveSecret(storage, seed);
+				return storage.data();
+			}
+		} // namespace
+
+		uint64_t xxh3_64(const uint8_t *const data, const size_t dataLen, const uint64_t seed) noexcept
+		{
+			if (dataLen <= midsizeMax)
+				return hash64Short(data, dataLen, seed);
+			secret_t storage{};
+			const auto *const secret{longSecret(storage, seed)};
+			auto acc{initialAcc};
+			hashLong(acc, data, dataLen, secret);
+			return merge64(acc, secret, dataLen);
+		}
+
+		std::pair<uint64_t, uint64_t> xxh3_128(const uint8_t *const data, const size_t dataLen, const uint64_t seed) noexcept
+		{
+			if (dataLen <= midsizeMax)
+				return hash128Short(data, dataLen, seed);
+			secret_t storage{};
+			const auto *const secret{longSecret(storage, seed)};
+			auto acc{initialAcc};
+			hashLong(acc, data, dataLen, secret);
+			return merge128(acc, secret, dataLen);
+		}
+	} // namespace internal
+
+	xxh3_t::xxh3_t(const uint64_t seed) noexcept : _seed{seed}
+	{
+		if (seed)
+			internal::deriveSecret(_secret, seed);
+		else
+			_secret = internal::defaultSecret;
+		reset();
+	}
+
+	void xxh3_t::reset() noexcept
+	{
+		_acc = internal::initialAcc;
+		_bufferedSize = 0U;
+		_stripesSoFar = 0U;
+		_totalLength = 0U;
+	}
+
+	void xxh3_t::update(const uint8_t *data, size_t dataLen) noexcept
+	{
+		if (!data || !dataLen)
+			return;
+		_totalLength += dataLen;
+		if (dataLen <= bufferLength - _bufferedSize)
+		{
+			std::memcpy(_buffer.data() + _bufferedSize, data, dataLen);
+			_bufferedSize += dataLen;
+			return;
+		}
+
+		constexpr auto bufferStripes{bufferLength / internal::stripeLength};
+		// Top the buffer up and consume it, always leaving something behind for the final stripe
+		if (_bufferedSize)
+		{
+			const auto amount{bufferLength - _bufferedSize};
+			std::memcpy(_buffer.data() + _bufferedSize, data, amount);
+			data += amount;
+			dataLen -= amount;
+			internal::consumeStripes(_acc, _stripesSoFar, _buffer.data(), bufferStripes, _secret.data());
+			_bufferedSize = 0U;
+		}
+
+		if (dataLen > bufferLength)
+		{
+			// Consume directly from the caller's buffer, keeping a copy of the last stripe for finalisation
+			do
+			{
+				internal::consumeStripes(_acc, _stripesSoFar, data, bufferStripes, _secret.data());
+				data += bufferLength;
+				dataLen -= bufferLength;
+			}
+			while (dataLen > bufferLength);
+			std::memcpy(_buffer.data() + bufferLength - internal::stripeLength, data - internal::stripeLength,
+				internal::stripeLength);
+		}
+
+		std::memcpy(_buffer.data(), data, dataLen);
+		_bufferedSize = dataLen;
+	}
+
+	void xxh3_t::digestLong(std::array<uint64_t, 8> &acc) const noexcept
+	{
+		const auto &kernels{internal::stripeKernels()};
+		const auto *const secret{_secret.data()};
+		if (_bufferedSize >= internal::stripeLength)
+		{
+			const auto stripes{(_bufferedSize - 1U) / internal::stripeLength};
+			auto stripesSoFar{_stripesSoFar};
+			internal::consumeStripes(acc, stripesSoFar, _buffer.data(), stripes, secret);
+			kernels.accumulate(acc, _buffer.data() + _bufferedSize - internal::stripeLength,
+				secret + internal::secretLimit - internal::lastStripeOffset, 1U);
+		}
+		else
+		{
+			// Stitch the last stripe together from the tail of the previous buffer load and what's buffered now
+			std::array<uint8_t, internal::stripeLength> lastStripe{};
+			const auto catchup{internal::stripeLength - _bufferedSize};
+			std::memcpy(lastStripe.data(), _buffer.data() + bufferLength - catchup, catchup);
+			std::memcpy(lastStripe.data() + catchup, _buffer.data(), _bufferedSize);
+			kernels.accumulate(acc, lastStripe.data(), secret + internal::secretLimit - internal::lastStripeOffset, 1U);
+		}
+	}
+
+	uint64_t xxh3_t::value64() const noexcept
+	{
+		if (_totalLength <= internal::midsizeMax)
+			return internal::hash64Short(_buffer.data(), _bufferedSize, _seed);
+		auto acc{_acc};
+		digestLong(acc);
+		return internal::merge64(acc, _secret.data(), _totalLength);
+	}
+
+	std::pair<uint64_t, uint64_t> xxh3_t::value128() const noexcept
+	{
+		if (_totalLength <= internal::midsizeMax)
+			return internal::hash128Short(_buffer.data(), _bufferedSize, _seed);
+		auto acc{_acc};
+		digestLong(acc);
+		return internal::merge128(acc, _secret.data(), _totalLength);
+	}
+} // namespace substrate
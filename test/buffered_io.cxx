@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <substrate/advanced/buffered_io>
+#include <substrate/fd>
+#include <catch2/catch_test_macros.hpp>
+
+using substrate::advanced::bufferedReader_t;
+using substrate::advanced::bufferedWriter_t;
+
+namespace
+{
+	// In-memory source that counts the reads made of it and hands out at most `chunk` bytes per read
+	struct memorySource_t final : public substrate::advanced::readable_t
+	{
+		std::vector<uint8_t> data{};
+		size_t chunk{SIZE_MAX};
+		bool failing{false};
+		mutable size_t offset{};
+		mutable size_t reads{};
+
+		using substrate::advanced::readable_t::read;
+
+		ssize_t read(void *const bufferPtr, const size_t bufferLen, std::nullptr_t) const noexcept final
+		{
+			++reads;
+			if (failing)
+				return -1;
+			const auto count{std::min({bufferLen, chunk, data.size() - offset})};
+			std::memcpy(bufferPtr, data.data() + offset, count);
+			offset += count;
+			return ssize_t(count);
+		}
+	};
+
+	// In-memory sink that counts the writes made to it and accepts at most `chunk` bytes per write
+	struct memorySink_t final : public substrate::advanced::writeable_t
+	{
+		mutable std::vector<uint8_t> data{};
+		size_t chunk{SIZE_MAX};
+		bool failing{false};
+		mutable size_t writes{};
+
+		using substrate::advanced::writeable_t::write;
+
+		ssize_t write(const void *const bufferPtr, const size_t bufferLen, std::nullptr_t) const noexcept final
+		{
+			++writes;
+			if (failing)
+				return -1;
+			const auto count{std::min(bufferLen, chunk)};
+			const auto *const bytes{static_cast<const uint8_t *>(bufferPtr)};
+			data.insert(data.end(), bytes, bytes + count);
+			return ssize_t(count);
+		}
+	};
+
+	std::vector<uint8_t> makeData(const size_t length)
+	{
+		std::vector<uint8_t> data(length);
+		for (size_t i{}; i < length; ++i)
+			data[i] = uint8_t((i * 7U) + (i >> 8U));
+		return data;
+	}
+} // namespace
+
+TEST_CASE("bufferedReader_t typed reads", "[bufferedReader_t]")
+{
+	memorySource_t source{};
+	source.data = {
+		0x5AU, 0x34U, 0x12U, 0x78U, 0x56U, 0x34U, 0x12U, 0x12U, 0x34U, 0x56U, 0x78U,
+		0x9AU, 0xBCU, 0xDEU, 0xF0U, 0xA5U
+	};
+	bufferedReader_t reader{source};
+	REQUIRE(reader.valid());
+	REQUIRE(reader.bufferSize() == size_t{bufferedReader_t::defaultBufferSize});
+
+	uint8_t u8{};
+	uint16_t u16{};
+	uint32_t u32{};
+	uint64_t u64{};
+	REQUIRE(reader.read(u8));
+	REQUIRE(u8 == 0x5AU);
+	REQUIRE(reader.readLE(u16));
+	REQUIRE(u16 == 0x1234U);
+	REQUIRE(reader.readLE(u32));
+	REQUIRE(u32 == 0x12345678U);
+	REQUIRE(reader.readBE(u64));
+	REQUIRE(u64 == UINT64_C(0x123456789ABCDEF0));
+	// Everything above came out of the one read that filled the buffer
+	REQUIRE(source.reads == 1U);
+	REQUIRE(reader.available() == 1U);
+	REQUIRE_FALSE(reader.isEOF());
+
+	// Asking for more than is left gives a short read that the typed helpers report as a failure
+	REQUIRE_FALSE(reader.readLE(u16));
+	REQUIRE(reader.isEOF());
+	REQUIRE_FALSE(reader.read(u8));
+}
+
+TEST_CASE("bufferedReader_t short source reads", "[bufferedReader_t]")
+{
+	memorySource_t source{};
+	source.data = makeData(1000U);
+	source.chunk = 3U;
+	bufferedReader_t reader{source, 64U};
+	REQUIRE(reader.bufferSize() == 64U);
+
+	// The reader keeps asking until it has what was wanted, whatever sizes the source hands back
+	for (size_t offset{}; offset < 1000U; offset += 8U)
+	{
+		uint64_t value{};
+		REQUIRE(reader.readLE(value));
+		uint64_t expected{};
+		for (size_t byte{}; byte < 8U; ++byte)
+			expected |= uint64_t{source.data[offset + byte]} << (byte * 8U);
+		REQUIRE(value == expected);
+	}
+	uint8_t junk{};
+	REQUIRE_FALSE(reader.read(junk));
+	REQUIRE(reader.isEOF());
+}
+
+TEST_CASE("bufferedReader_t large reads", "[bufferedReader_t]")
+{
+	memorySource_t source{};
+	source.data = makeData(4096U);
+	bufferedReader_t reader{source, 256U};
+
+	std::array<uint8_t, 16> head{};
+	REQUIRE(reader.read(head));
+	REQUIRE(source.reads == 1U);
+	REQUIRE(reader.available() == 240U);
+
+	// A read bigger than the buffer drains what's buffered, then reads the rest straight into place
+	std::vector<uint8_t> body(1024U);
+	REQUIRE(reader.read(body.data(), body.size()));
+	REQUIRE(source.reads == 2U);
+	REQUIRE(reader.available() == 0U);
+	REQUIRE(std::equal(body.begin(), body.end(), source.data.begin() + 16));
+
+	std::vector<uint8_t> tail(4096U);
+	size_t resultLen{};
+	REQUIRE_FALSE(reader.read(tail.data(), tail.size(), resultLen));
+	REQUIRE(resultLen == 4096U - 1040U);
+	REQUIRE(std::equal(tail.begin(), tail.begin() + ssize_t(resultLen), source.data.begin() + 1040));
+	REQUIRE(reader.isEOF());
+}
+
+TEST_CASE("bufferedReader_t peek and consume", "[bufferedReader_t]")
+{
+	memorySource_t source{};
+	source.data = makeData(200U);
+	source.chunk = 50U;
+	bufferedReader_t reader{source, 128U};
+
+	auto view{reader.peek(4U)};
+	REQUIRE(view.size() == 4U);
+	REQUIRE(std::equal(view.begin(), view.end(), source.data.begin()));
+	// Peeking doesn't consume, so the same bytes come back again
+	view = reader.peek(2U);
+	REQUIRE(view.size() == 2U);
+	REQUIRE(view[0] == source.data[0]);
+	REQUIRE(reader.consume(4U) == 4U);
+
+	// Peeking past what's buffered tops the buffer up
+	view = reader.peek(100U);
+	REQUIRE(view.size() == 100U);
+	REQUIRE(std::equal(view.begin(), view.end(), source.data.begin() + 4));
+	REQUIRE(reader.consume(100U) == 100U);
+
+	// The view is capped at the buffer size and at the end of the data
+	view = reader.peek(1000U);
+	REQUIRE(view.size() == 96U);
+	REQUIRE(std::equal(view.begin(), view.end(), source.data.begin() + 104));
+	REQUIRE(reader.consume(1000U) == 96U);
+	REQUIRE(reader.peek(1U).empty());
+	REQUIRE(reader.isEOF());
+	REQUIRE(reader.consume(1U) == 0U);
+}
+
+TEST_CASE("bufferedReader_t source failure", "[bufferedReader_t]")
+{
+	memorySource_t source{};
+	source.data = makeData(16U);
+	source.chunk = 4U;
+	bufferedReader_t reader{source, 32U};
+	REQUIRE(reader.peek(2U).size() == 2U);
+	REQUIRE(reader.available() == 4U);
+
+	source.failing = true;
+	// What's already buffered can still be had, and a short read is returned when the source fails
+	std::array<uint8_t, 8> data{};
+	REQUIRE(reader.read(data.data(), data.size(), nullptr) == 4);
+	REQUIRE(reader.read(data.data(), data.size(), nullptr) == -1);
+	REQUIRE_FALSE(reader.isEOF());
+}
+
+TEST_CASE("bufferedWriter_t typed writes", "[bufferedWriter_t]")
+{
+	memorySink_t sink{};
+	{
+		bufferedWriter_t writer{sink};
+		REQUIRE(writer.valid());
+		REQUIRE(writer.write(uint8_t{0x5AU}));
+		REQUIRE(writer.writeLE(uint16_t{0x1234U}));
+		REQUIRE(writer.writeLE(uint32_t{0x12345678U}));
+		REQUIRE(writer.writeBE(UINT64_C(0x123456789ABCDEF0)));
+		REQUIRE(writer.writeBE(int16_t{-2}));
+		REQUIRE(writer.buffered() == 17U);
+		REQUIRE(sink.writes == 0U);
+		REQUIRE(writer.flush());
+		REQUIRE(sink.writes == 1U);
+		REQUIRE(writer.buffered() == 0U);
+		// Flushing with nothing buffered doesn't touch the sink
+		REQUIRE(writer.flush());
+		REQUIRE(sink.writes == 1U);
+		REQUIRE(writer.write(std::string{"tail"}));
+	}
+	// Destruction flushes whatever is left
+	REQUIRE(sink.writes == 2U);
+	const std::vector<uint8_t> expected{
+		0x5AU, 0x34U, 0x12U, 0x78U, 0x56U, 0x34U, 0x12U, 0x12U, 0x34U, 0x56U, 0x78U,
+		0x9AU, 0xBCU, 0xDEU, 0xF0U, 0xFFU, 0xFEU, 't', 'a', 'i', 'l'
+	};
+	REQUIRE(sink.data == expected);
+}
+
+TEST_CASE("bufferedWriter_t buffer limits", "[bufferedWriter_t]")
+{
+	memorySink_t sink{};
+	sink.chunk = 7U;
+	const auto data{makeData(1000U)};
+	bufferedWriter_t writer{sink, 64U};
+
+	// Small writes are gathered up and handed over a buffer at a time, retrying the sink's short writes
+	for (size_t offset{}; offset < 200U; offset += 8U)
+		REQUIRE(writer.write(data.data() + offset, 8U));
+	REQUIRE(sink.data.size() == 192U);
+	REQUIRE(writer.buffered() == 8U);
+
+	// Writes the size of the buffer or bigger bypass it, after what's buffered
+	REQUIRE(writer.write(data.data() + 200U, 800U));
+	REQUIRE(writer.buffered() == 0U);
+	REQUIRE(sink.data == data);
+}
+
+TEST_CASE("bufferedWriter_t sink failure", "[bufferedWriter_t]")
+{
+	memorySink_t sink{};
+	sink.chunk = 4U;
+	const auto data{makeData(32U)};
+	bufferedWriter_t writer{sink, 16U};
+	REQUIRE(writer.write(data.data(), 10U));
+
+	sink.failing = true;
+	REQUIRE_FALSE(writer.flush());
+	REQUIRE(writer.buffered() == 10U);
+	// The buffer is still full enough that this needs a flush, which fails
+	REQUIRE(writer.write(data.data() + 10U, 8U, nullptr) == -1);
+
+	// Once the sink recovers nothing has been lost
+	sink.failing = false;
+	REQUIRE(writer.flush());
+	REQUIRE(writer.write(data.data() + 10U, 22U));
+	REQUIRE(sink.data.size() == 32U);
+	REQUIRE(sink.data == data);
+}
+
+TEST_CASE("buffered fd_t round trip", "[bufferedReader_t][bufferedWriter_t]")
+{
+	constexpr size_t count{10000U};
+	{
+		substrate::fd_t file{"buffered_io.test", O_WRONLY | O_CREAT | O_TRUNC, substrate::normalMode};
+		REQUIRE(file.valid());
+		bufferedWriter_t writer{file, 4096U};
+		for (size_t i{}; i < count; ++i)
+		{
+			REQUIRE(writer.writeLE(uint32_t(i * 2654435761U)));
+			REQUIRE(writer.writeBE(uint16_t(i)));
+		}
+		REQUIRE(writer.flush());
+		REQUIRE(file.length() == off_t(count * 6U));
+	}
+
+	substrate::fd_t file{"buffered_io.test", O_RDONLY};
+	REQUIRE(file.valid());
+	bufferedReader_t reader{file, 4096U};
+	for (size_t i{}; i < count; ++i)
+	{
+		uint32_t word{};
+		uint16_t half{};
+		REQUIRE(reader.readLE(word));
+		REQUIRE(word == uint32_t(i * 2654435761U));
+		REQUIRE(reader.readBE(half));
+		REQUIRE(half == uint16_t(i));
+	}
+	uint8_t junk{};
+	REQUIRE_FALSE(reader.read(junk));
+	REQUIRE(reader.isEOF());
+	REQUIRE(file.isEOF());
+	unlink("buffered_io.test");
+}
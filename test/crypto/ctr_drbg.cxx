@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#	include <sys/wait.h>
+#	include <unistd.h>
+#endif
+#include <substrate/crypto/ctr_drbg>
+#include <substrate/prng>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace substrate;
+using substrate::crypto::ctrDrbg_t;
+
+namespace
+{
+	size_t countBits(const std::vector<uint8_t> &data) noexcept
+	{
+		size_t bits{};
+		for (auto value : data)
+		{
+			for (; value; value &= uint8_t(value - 1U))
+				++bits;
+		}
+		return bits;
+	}
+} // namespace
+
+TEST_CASE("output", "[ctrDrbg_t]")
+{
+	ctrDrbg_t drbg{};
+	REQUIRE(drbg.reseeds() == 1U);
+
+	// Draws of every size, including ones spanning several buffers, all come out different
+	std::vector<std::vector<uint8_t>> draws{};
+	for (const size_t length : {size_t{1U}, size_t{15U}, size_t{16U}, size_t{17U}, size_t{1000U},
+		ctrDrbg_t::bufferSize + 17U, ctrDrbg_t::bufferSize * 3U})
+	{
+		std::vector<uint8_t> data(length);
+		drbg.fill(data);
+		// Only compare where there are enough bytes for a chance match not to be a worry
+		for (const auto &draw : draws)
+		{
+			const auto common{std::min(draw.size(), data.size())};
+			if (common >= 8U)
+				REQUIRE(std::memcmp(data.data(), draw.data(), common) != 0);
+		}
+		draws.push_back(std::move(data));
+	}
+	drbg.fill({});
+
+	// Of a megabyte of output, the share of one bits must be within a few standard deviations of half
+	std::vector<uint8_t> data(1024U * 1024U);
+	drbg.fill(data);
+	const auto bits{countBits(data)};
+	REQUIRE(bits > (data.size() * 4U) - 6000U);
+	REQUIRE(bits < (data.size() * 4U) + 6000U);
+
+	std::array<uint8_t, 32> first{{}};
+	std::array<uint8_t, 32> second{{}};
+	ctrDrbg_t other{};
+	drbg.fill(first);
+	other.fill(second);
+	REQUIRE(first != second);
+}
+
+TEST_CASE("reseeding", "[ctrDrbg_t]")
+{
+	// A buffer holds a little less than bufferSize of output, so each of these draws runs into a new one
+	std::array<uint8_t, 1000> small{{}};
+	std::vector<uint8_t> data(ctrDrbg_t::bufferSize);
+
+	// With a limit of one byte every refill after the first starts with a reseed
+	ctrDrbg_t byBytes{1U};
+	byBytes.fill(small);
+	REQUIRE(byBytes.reseeds() == 1U);
+	byBytes.fill(data);
+	byBytes.fill(data);
+	REQUIRE(byBytes.reseeds() == 3U);
+
+	ctrDrbg_t byTime{UINT64_MAX, std::chrono::milliseconds{1}};
+	byTime.fill(small);
+	REQUIRE(byTime.reseeds() == 1U);
+	std::this_thread::sleep_for(std::chrono::milliseconds{5});
+	byTime.fill(data);
+	REQUIRE(byTime.reseeds() == 2U);
+
+	ctrDrbg_t drbg{};
+	SUBSTRATE_NOWARN_UNUSED(const auto value) = drbg();
+	drbg.reseed();
+	REQUIRE(drbg.reseeds() == 2U);
+}
+
+#ifndef _WIN32
+TEST_CASE("fork safety", "[ctrDrbg_t]")
+{
+	ctrDrbg_t drbg{};
+	// Get a buffer's worth of output waiting so the child would see it if the pid check didn't catch the fork
+	SUBSTRATE_NOWARN_UNUSED(const auto value) = drbg();
+
+	std::array<int, 2> fds{{}};
+	REQUIRE(pipe(fds.data()) == 0);
+	const auto child{fork()};
+	REQUIRE(child >= 0);
+	if (!child)
+	{
+		std::array<uint64_t, 5> result{{}};
+		drbg.fill({reinterpret_cast<uint8_t *>(result.data()), sizeof(uint64_t) * 4U});
+		result[4] = drbg.reseeds();
+		const auto written{write(fds[1], result.data(), sizeof(result))};
+		_exit(written == sizeof(result) ? 0 : 1);
+	}
+
+	std::array<uint64_t, 5> parent{{}};
+	drbg.fill({reinterpret_cast<uint8_t *>(parent.data()), sizeof(uint64_t) * 4U});
+	std::array<uint64_t, 5> fromChild{{}};
+	REQUIRE(read(fds[0], fromChild.data(), sizeof(fromChild)) == sizeof(fromChild));
+	int status{};
+	REQUIRE(waitpid(child, &status, 0) == child);
+	REQUIRE(WIFEXITED(status));
+	REQUIRE(WEXITSTATUS(status) == 0);
+	close(fds[0]);
+	close(fds[1]);
+
+	REQUIRE(drbg.reseeds() == 1U);
+	REQUIRE(fromChild[4] == 2U);
+	for (size_t i{}; i < 4U; ++i)
+		REQUIRE(parent[i] != fromChild[i]);
+}
+#endif
+
+TEST_CASE("thread_instance()", "[ctrDrbg_t]")
+{
+	auto &local{ctrDrbg_t::thread_instance()};
+	REQUIRE(&local == &ctrDrbg_t::thread_instance());
+	const ctrDrbg_t *otherInstance{};
+	std::thread thread{[&]() { otherInstance = &ctrDrbg_t::thread_instance(); }};
+	thread.join();
+	REQUIRE(otherInstance != &local);
+
+	// A UniformRandomBitGenerator, so the prng distributions take it
+	for (size_t i{}; i < 100U; ++i)
+		REQUIRE(bounded(local, uint64_t{10U}) < 10U);
+}
@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <substrate/crypto/hmac>
+#include <substrate/crypto/sha256>
+#include <substrate/crypto/sha512>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace substrate;
+
+namespace
+{
+	std::vector<uint8_t> fromHex(const std::string &hex)
+	{
+		std::vector<uint8_t> result{};
+		for (size_t i{}; i + 1U < hex.size(); i += 2U)
+			result.push_back(uint8_t(std::stoul(hex.substr(i, 2U), nullptr, 16)));
+		return result;
+	}
+
+	std::vector<uint8_t> fromString(const std::string &str)
+		{ return {str.begin(), str.end()}; }
+
+	template<typename digest_t> std::vector<uint8_t> toVector(const digest_t &digest)
+		{ return {digest.begin(), digest.end()}; }
+
+	struct hmacVector_t final
+	{
+		std::vector<uint8_t> key;
+		std::vector<uint8_t> data;
+		std::string sha256;
+		std::string sha512;
+	};
+
+	// RFC 4231 test cases 1 through 4, 6 and 7, case 5 checks truncated output so is done on its own
+	const std::vector<hmacVector_t> hmacVectors
+	{
+		{
+			std::vector<uint8_t>(20U, 0x0BU), fromString("Hi There"),
+			"b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+			"87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cde"
+			"daa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854"
+		},
+		{
+			fromString("Jefe"), fromString("what do ya want for nothing?"),
+			"5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+			"164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+			"9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737"
+		},
+		{
+			std::vector<uint8_t>(20U, 0xAAU), std::vector<uint8_t>(50U, 0xDDU),
+			"773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe",
+			"fa73b0089d56a284efb0f0756c890be9b1b5dbdd8ee81a3655f83e33b2279d39"
+			"bf3e848279a722c806b485a47e67c807b946a337bee8942674278859e13292fb"
+		},
+		{
+			fromHex("0102030405060708090a0b0c0d0e0f10111213141516171819"), std::vector<uint8_t>(50U, 0xCDU),
+			"82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b",
+			"b0ba465637458c6990e5a8c5f61d4af7e576d97ff94b872de76f8050361ee3db"
+			"a91ca5c11aa25eb4d679275cc5788063a5f19741120c4f2de2adebeb10a298dd"
+		},
+		{
+			std::vector<uint8_t>(131U, 0xAAU), fromString("Test Using Larger Than Block-Size Key - Hash Key First"),
+			"60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54",
+			"80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352"
+			"6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598"
+		},
+		{
+			std::vector<uint8_t>(131U, 0xAAU), fromString("This is a test using a larger than block-size key and a "
+				"larger than block-size data. The key needs to be hashed before being used by the HMAC algorithm."),
+			"9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2",
+			"e37b6a775dc87dbaa4dfa9f96e5e3ffddebd71f8867289865df5a32d20cdc944"
+			"b6022cac3c4982b10d5eeb55c3e4de15134676fb6de0446065c97440fa8c6a58"
+		},
+	};
+} // namespace
+
+TEST_CASE("hmac: RFC 4231 vectors", "[crypto/hmac]")
+{
+	for (const auto &vector : hmacVectors)
+	{
+		crypto::hmac_t<crypto::sha256_t> hmac256{vector.key};
+		crypto::hmac_t<crypto::sha512_t> hmac512{vector.key};
+		REQUIRE(toVector(hmac256.mac(vector.data)) == fromHex(vector.sha256));
+		REQUIRE(toVector(hmac512.mac(vector.data)) == fromHex(vector.sha512));
+	}
+
+	// Test case 5, where only the leading 128 bits of the MAC are given
+	const std::vector<uint8_t> key(20U, 0x0CU);
+	const auto data{fromString("Test With Truncation")};
+	crypto::hmac_t<crypto::sha256_t> hmac256{key};
+	crypto::hmac_t<crypto::sha512_t> hmac512{key};
+	const auto digest256{toVector(hmac256.mac(data))};
+	const auto digest512{toVector(hmac512.mac(data))};
+	REQUIRE(std::vector<uint8_t>{digest256.begin(), digest256.begin() + 16} ==
+		fromHex("a3b6167473100ee06e0c796c2955552b"));
+	REQUIRE(std::vector<uint8_t>{digest512.begin(), digest512.begin() + 16} ==
+		fromHex("415fad6271580a531d4179bc891d87a6"));
+}
+
+TEST_CASE("hmac: reuse and streaming", "[crypto/hmac]")
+{
+	const auto &vector{hmacVectors.back()};
+	crypto::hmac_t<crypto::sha256_t> hmac{vector.key};
+
+	// The cached pad states must come back untouched after every MAC
+	for (size_t i{}; i < 3U; ++i)
+		REQUIRE(toVector(hmac.mac(vector.data)) == fromHex(vector.sha256));
+
+	for (const size_t step : {1U, 7U, 64U, 100U})
+	{
+		for (size_t offset{}; offset < vector.data.size(); offset += step)
+			hmac.update(vector.data.data() + offset, std::min(step, vector.data.size() - offset));
+		REQUIRE(toVector(hmac.finalize()) == fromHex(vector.sha256));
+	}
+
+	hmac.set_key(hmacVectors[1].key);
+	REQUIRE(toVector(hmac.mac(hmacVectors[1].data)) == fromHex(hmacVectors[1].sha256));
+}
+
+TEST_CASE("hkdf: RFC 5869 vectors", "[crypto/hmac]")
+{
+	struct hkdfVector_t final
+	{
+		std::vector<uint8_t> ikm;
+		std::vector<uint8_t> salt;
+		std::vector<uint8_t> info;
+		std::string prk;
+		std::string okm;
+	};
+
+	// Test cases 1 through 3, the SHA-256 ones
+	const std::vector<hkdfVector_t> vectors
+	{
+		{
+			std::vector<uint8_t>(22U, 0x0BU), fromHex("000102030405060708090a0b0c"), fromHex("f0f1f2f3f4f5f6f7f8f9"),
+			"077709362c2e32df0ddc3f0dc47bba6390b6c73bb50f9c3122ec844ad7c2b3e5",
+			"3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865"
+		},
+		{
+			fromHex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+				"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f404142434445464748494a4b4c4d4e4f"),
+			fromHex("606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+				"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9fa0a1a2a3a4a5a6a7a8a9aaabacadaeaf"),
+			fromHex("b0b1b2b3b4b5b6b7b8b9babbbcbdbebfc0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+				"d0d1d2d3d4d5d6d7d8d9dadbdcdddedfe0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff"),
+			"06a6b88c5853361a06104c9ceb35b45cef760014904671014a193f40c15fc244",
+			"b11e398dc80327a1c8e7f78c596a49344f012eda2d4efad8a050cc4c19afa97c"
+			"59045a99cac7827271cb41c65e590e09da3275600c2f09b8367793a9aca3db71cc30c58179ec3e87c14c01d5c1f3434f1d87"
+		},
+		{
+			std::vector<uint8_t>(22U, 0x0BU), {}, {},
+			"19ef24a32c717b167f33a91d6f648bdf96596776afdb6377ac434c1c293ccb04",
+			"8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d9d201395faa4b61a96c8"
+		},
+	};
+
+	for (const auto &vector : vectors)
+	{
+		const auto prk{crypto::hkdf_extract<crypto::sha256_t>(vector.salt, vector.ikm)};
+		REQUIRE(toVector(prk) == fromHex(vector.prk));
+
+		const auto expected{fromHex(vector.okm)};
+		std::vector<uint8_t> okm(expected.size());
+		crypto::hkdf_expand<crypto::sha256_t>(prk, vector.info, okm);
+		REQUIRE(okm == expected);
+
+		std::vector<uint8_t> oneShot(expected.size());
+		crypto::hkdf<crypto::sha256_t>(vector.salt, vector.ikm, vector.info, oneShot);
+		REQUIRE(oneShot == expected);
+	}
+}
+
+/* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
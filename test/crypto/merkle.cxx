@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <substrate/crypto/merkle>
+#include <substrate/mmap>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace substrate;
+using digest_t = crypto::merkle_t::digest_t;
+
+namespace
+{
+	std::vector<uint8_t> fromHex(const std::string &hex)
+	{
+		std::vector<uint8_t> result{};
+		for (size_t i{}; i + 1U < hex.size(); i += 2U)
+			result.push_back(uint8_t(std::stoul(hex.substr(i, 2U), nullptr, 16)));
+		return result;
+	}
+
+	std::vector<uint8_t> toVector(const digest_t &digest) { return {digest.begin(), digest.end()}; }
+
+	std::vector<uint8_t> makeData(const size_t length, const uint32_t seed = 0U)
+	{
+		std::vector<uint8_t> data(length);
+		std::minstd_rand rng{seed + 1U};
+		for (auto &value : data)
+			value = uint8_t(rng());
+		return data;
+	}
+
+	// The RFC 6962 recursive definition, which the level by level build must match
+	digest_t referenceRoot(const std::vector<digest_t> &leaves, const size_t begin, const size_t end)
+	{
+		if (end - begin == 1U)
+			return leaves[begin];
+		size_t split{1U};
+		while (split * 2U < end - begin)
+			split *= 2U;
+		return crypto::merkle_t::hash_node(referenceRoot(leaves, begin, begin + split),
+			referenceRoot(leaves, begin + split, end));
+	}
+
+	digest_t referenceRoot(const std::vector<uint8_t> &data, const size_t chunkSize)
+	{
+		std::vector<digest_t> leaves{};
+		for (size_t offset{}; offset < data.size(); offset += chunkSize)
+			leaves.push_back(crypto::merkle_t::hash_leaf({data.data() + offset,
+				std::min(chunkSize, data.size() - offset)}));
+		return referenceRoot(leaves, 0U, leaves.size());
+	}
+} // namespace
+
+TEST_CASE("merkle: known roots", "[crypto/merkle]")
+{
+	std::vector<uint8_t> data(1000U);
+	for (size_t i{}; i < data.size(); ++i)
+		data[i] = uint8_t(i);
+
+	// Computed independently with Python's hashlib
+	REQUIRE(toVector(crypto::merkle_t{100U}.hash(data)) ==
+		fromHex("fe948b736ee1bff96360f571f6b71c50e6a7a99c562340d69bc7799ebec63555"));
+	REQUIRE(toVector(crypto::merkle_t{64U}.hash(data)) ==
+		fromHex("49e5aa5f16391c46ad39f954fe0cab56ff1d6e6822bb26e3d888b33610f40286"));
+	REQUIRE(toVector(crypto::merkle_t{7U}.hash(data)) ==
+		fromHex("bb3631ed6d960b0837c40b9b88ad93a058a5b55450c41513d781919ee57e9bea"));
+
+	crypto::merkle_t single{};
+	REQUIRE(toVector(single.hash(data)) ==
+		fromHex("b3f81a3986cb4ad0b1fa2f76747a9a6c354d97b93aaf624f99f54f07c83e0721"));
+	REQUIRE(single.chunks() == 1U);
+	REQUIRE(single.levels() == 1U);
+
+	crypto::merkle_t empty{};
+	REQUIRE(toVector(empty.hash(span<const uint8_t>{})) ==
+		fromHex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+	REQUIRE(empty.chunks() == 0U);
+}
+
+TEST_CASE("merkle: layout", "[crypto/merkle]")
+{
+	const auto data{makeData(5000U)};
+	for (const size_t chunkSize : {1U, 3U, 64U, 511U, 512U, 4999U, 5000U, 5001U})
+	{
+		crypto::merkle_t tree{chunkSize};
+		REQUIRE(tree.hash(data) == referenceRoot(data, chunkSize));
+		REQUIRE(tree.chunks() == (data.size() + chunkSize - 1U) / chunkSize);
+		for (size_t level{1U}; level < tree.levels(); ++level)
+			REQUIRE(tree.level(level).size() == (tree.level(level - 1U).size() + 1U) / 2U);
+		REQUIRE(tree.level(tree.levels() - 1U).size() == 1U);
+		REQUIRE(tree.level(tree.levels() - 1U).front() == tree.root());
+	}
+}
+
+TEST_CASE("merkle: threaded leaves", "[crypto/merkle]")
+{
+	// Large enough to be spread across the thread pool
+	const auto data{makeData((4U << 20U) + 12345U)};
+	crypto::merkle_t tree{4096U};
+	REQUIRE(tree.hash(data) == referenceRoot(data, 4096U));
+
+#ifndef _WIN32
+	mmap_t map{-1, data.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS};
+	REQUIRE(map.valid());
+	std::memcpy(map.address<uint8_t>(), data.data(), data.size());
+	crypto::merkle_t mapped{4096U};
+	REQUIRE(mapped.hash_map(map) == tree.root());
+	// A braced pointer and length picks the span overload
+	REQUIRE(mapped.hash({map.address<uint8_t>(), map.length()}) == tree.root());
+
+	// Rewrite a scattering of chunks through the mapping and only rehash those
+	std::vector<size_t> changed{};
+	for (size_t chunk{3U}; chunk < mapped.chunks(); chunk += 97U)
+	{
+		map.address<uint8_t>()[chunk * 4096U + 5U] ^= 0xFFU;
+		changed.push_back(chunk);
+	}
+	std::vector<uint8_t> copy(map.length());
+	std::memcpy(copy.data(), map.address<uint8_t>(), copy.size());
+	REQUIRE(mapped.rehash_map(map, changed) == referenceRoot(copy, 4096U));
+#endif
+}
+
+TEST_CASE("merkle: incremental rehash", "[crypto/merkle]")
+{
+	constexpr size_t chunkSize{16U};
+	std::minstd_rand rng{42U};
+	auto data{makeData(1000U)};
+	crypto::merkle_t tree{chunkSize};
+	static_cast<void>(tree.hash(data));
+
+	for (size_t round{}; round < 200U; ++round)
+	{
+		std::vector<size_t> changed{};
+		const auto edits{rng() % 4U};
+		for (size_t edit{}; edit < edits && !data.empty(); ++edit)
+		{
+			const auto offset{rng() % data.size()};
+			data[offset] ^= uint8_t(1U + rng() % 255U);
+			changed.push_back(offset / chunkSize);
+			// Listing a chunk twice must be harmless
+			changed.push_back(offset / chunkSize);
+		}
+		// Every few rounds grow or shrink the data, which the tree has to notice by itself
+		if (round % 5U == 0U)
+		{
+			const auto length{rng() % 1200U};
+			const auto oldLength{data.size()};
+			data.resize(length);
+			for (auto offset{oldLength}; offset < length; ++offset)
+				data[offset] = uint8_t(rng());
+		}
+		// Chunks past the end are ignored
+		changed.push_back(data.size() / chunkSize + 10U);
+
+		REQUIRE(tree.rehash(data, changed) == referenceRoot(data, chunkSize));
+		crypto::merkle_t fresh{chunkSize};
+		static_cast<void>(fresh.hash(data));
+		REQUIRE(tree.levels() == fresh.levels());
+		for (size_t level{}; level < fresh.levels(); ++level)
+			REQUIRE(tree.level(level) == fresh.level(level));
+	}
+}
+
+/* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
@@ -1,5 +1,10 @@
 // SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
 #include <substrate/crypto/sha256>
 #include <catch2/catch_test_macros.hpp>
 
@@ -43,3 +48,183 @@ TEST_CASE("sha256: std::array<>", "[crypto/sha256]")
 	REQUIRE(hasher(small_input) == small_hash);
 
 }
+
+namespace
+{
+	crypto::sha256_t::digest_t fromHex(const char *const hex)
+	{
+		crypto::sha256_t::digest_t digest{{}};
+		for (size_t i{}; i < digest.size(); ++i)
+			digest[i] = uint8_t(std::stoul(std::string{hex + (i * 2U), 2U}, nullptr, 16));
+		return digest;
+	}
+
+	substrate::span<const uint8_t> asBytes(const std::string &str)
+	{
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		return {reinterpret_cast<const uint8_t *>(str.data()), str.size()};
+	}
+} // namespace
+
+TEST_CASE("sha256: FIPS 180 vectors", "[crypto/sha256]")
+{
+	crypto::sha256_t hasher{};
+	const std::string abc{"abc"};
+	const std::string twoBlock{"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"};
+	const std::string longer{"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"};
+
+	REQUIRE(hasher.hash(abc.data(), abc.size()) == fromHex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+	// hash() used to overflow its block buffer on anything longer than a single block
+	REQUIRE(hasher.hash(twoBlock.data(), twoBlock.size()) == fromHex("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+	REQUIRE(hasher.hash(longer.data(), longer.size()) == fromHex("cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"));
+	// The hasher must be reusable once a hash completes
+	REQUIRE(hasher.hash(abc.data(), abc.size()) == fromHex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+}
+
+TEST_CASE("sha256: streaming", "[crypto/sha256]")
+{
+	crypto::sha256_t hasher{};
+	const std::string million(1000000U, 'a');
+	// Feed the data in odd sized pieces so the partial block buffering is exercised
+	for (size_t offset{}; offset < million.size(); offset += 997U)
+		hasher.update(asBytes(million).subspan(offset, std::min<size_t>(997U, million.size() - offset)));
+	REQUIRE(hasher.finalize() == fromHex("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+
+	std::vector<uint8_t> data(192U);
+	for (size_t i{}; i < data.size(); ++i)
+		data[i] = uint8_t((i * 7U) + 3U);
+
+	// Lengths either side of where the padding and length no longer fit in the final block
+	const std::array<std::pair<size_t, const char *>, 6> vectors
+	{{
+		{55U, "e7313d333c272e639f790978283f9eb392e843d0f29b7016828bb1daa4aac70b"},
+		{56U, "4324d65f3c103567f5589c710bc08f8523f929a9272e3af36fc968e52abc6c27"},
+		{63U, "81c80242132f230c3bd41b3e63bbcff16107339549214a99614ff26664625055"},
+		{64U, "39e3d7b6b5d075d37d053ad89b24b41bef4f3c29760c84447cab3f3be1882241"},
+		{65U, "aacca6ff74fdbb296d165a45cecfa04e5127bc008770fbbdd48006f2d2fae95e"},
+		{133U, "938d47a3cfef5a4157be8a0d57d982f6784c31428fed751835efe34284949d53"},
+	}};
+	for (const auto &vector : vectors)
+	{
+		const auto expected{fromHex(vector.second)};
+		REQUIRE(hasher.hash(data.data(), vector.first) == expected);
+		for (const size_t chunk : {1U, 3U, 64U})
+		{
+			for (size_t offset{}; offset < vector.first; offset += chunk)
+				hasher.update(data.data() + offset, std::min(chunk, vector.first - offset));
+			REQUIRE(hasher.finalize() == expected);
+		}
+	}
+}
+
+TEST_CASE("sha256: many", "[crypto/sha256]")
+{
+	std::vector<uint8_t> data(8192U);
+	for (size_t i{}; i < data.size(); ++i)
+		data[i] = uint8_t((i * 131U) ^ (i >> 8U));
+
+	// A mix of sub-block, single block and ragged multi-block messages so the lanes drain unevenly
+	std::vector<span<const uint8_t>> messages{};
+	for (size_t i{}; i < 100U; ++i)
+	{
+		const auto length{(i * i * 37U) % data.size()};
+		messages.emplace_back(data.data() + (i % 7U), std::min(length, data.size() - (i % 7U)));
+	}
+	messages.emplace_back(data.data(), 0U);
+	messages.emplace_back(data.data(), 64U);
+	messages.emplace_back(data.data(), 55U);
+	messages.emplace_back(data.data(), 56U);
+
+	std::vector<crypto::sha256_t::digest_t> digests(messages.size());
+	crypto::sha256_many(messages, digests);
+	crypto::sha256_t hasher{};
+	for (size_t i{}; i < messages.size(); ++i)
+		REQUIRE(digests[i] == hasher.hash(messages[i]));
+
+	// Only as many messages as there are digests get hashed
+	std::vector<crypto::sha256_t::digest_t> fewer(3U);
+	crypto::sha256_many(messages, fewer);
+	for (size_t i{}; i < fewer.size(); ++i)
+		REQUIRE(fewer[i] == digests[i]);
+}
+
+#ifdef SUBSTRATE_HAVE_LIBRARY
+namespace
+{
+	// Pads and hashes message with the one compression kernel given, rather than whichever is dispatched to
+	crypto::sha256_t::digest_t hashWith(const internal::sha256Kernel_t kernel, const std::vector<uint8_t> &message)
+	{
+		std::array<uint32_t, 8> state
+		{{
+			UINT32_C(0x6A09E667), UINT32_C(0xBB67AE85), UINT32_C(0x3C6EF372), UINT32_C(0xA54FF53A),
+			UINT32_C(0x510E527F), UINT32_C(0x9B05688C), UINT32_C(0x1F83D9AB), UINT32_C(0x5BE0CD19),
+		}};
+		std::vector<uint8_t> padded{message};
+		padded.push_back(0x80U);
+		while (padded.size() % crypto::sha256_t::blockSize != 56U)
+			padded.push_back(0U);
+		for (size_t i{8U}; i; --i)
+			padded.push_back(uint8_t((uint64_t{message.size()} << 3U) >> ((i - 1U) * 8U)));
+		kernel(state, padded.data(), padded.size() / crypto::sha256_t::blockSize);
+
+		crypto::sha256_t::digest_t digest{{}};
+		for (size_t i{}; i < digest.size(); ++i)
+			digest[i] = uint8_t(state[i / 4U] >> ((3U - (i % 4U)) * 8U));
+		return digest;
+	}
+} // namespace
+
+TEST_CASE("sha256: kernels", "[crypto/sha256]")
+{
+	std::vector<uint8_t> data(192U);
+	for (size_t i{}; i < data.size(); ++i)
+		data[i] = uint8_t((i * 7U) + 3U);
+	const std::array<std::pair<size_t, const char *>, 6> vectors
+	{{
+		{55U, "e7313d333c272e639f790978283f9eb392e843d0f29b7016828bb1daa4aac70b"},
+		{56U, "4324d65f3c103567f5589c710bc08f8523f929a9272e3af36fc968e52abc6c27"},
+		{63U, "81c80242132f230c3bd41b3e63bbcff16107339549214a99614ff26664625055"},
+		{64U, "39e3d7b6b5d075d37d053ad89b24b41bef4f3c29760c84447cab3f3be1882241"},
+		{65U, "aacca6ff74fdbb296d165a45cecfa04e5127bc008770fbbdd48006f2d2fae95e"},
+		{133U, "938d47a3cfef5a4157be8a0d57d982f6784c31428fed751835efe34284949d53"},
+	}};
+
+	// Every compression kernel this CPU can run, not only the one dispatched to, must get the right answers
+	const auto kernels{internal::sha256Kernels()};
+	REQUIRE(kernels.size() >= 1U);
+	for (const auto &kernel : kernels)
+	{
+		INFO("Kernel " << kernel.name);
+		REQUIRE(hashWith(kernel.function, {'a', 'b', 'c'}) ==
+			fromHex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+		for (const auto &vector : vectors)
+			REQUIRE(hashWith(kernel.function, {data.begin(), data.begin() + std::ptrdiff_t(vector.first)}) ==
+				fromHex(vector.second));
+	}
+}
+
+TEST_CASE("sha256: many kernels", "[crypto/sha256]")
+{
+	std::vector<uint8_t> data(8192U);
+	for (size_t i{}; i < data.size(); ++i)
+		data[i] = uint8_t((i * 131U) ^ (i >> 8U));
+	std::vector<span<const uint8_t>> messages{};
+	for (size_t i{}; i < 100U; ++i)
+	{
+		const auto length{(i * i * 37U) % data.size()};
+		messages.emplace_back(data.data() + (i % 7U), std::min(length, data.size() - (i % 7U)));
+	}
+
+	crypto::sha256_t hasher{};
+	const auto kernels{internal::sha256ManyKernels()};
+	REQUIRE(kernels.size() >= 1U);
+	for (const auto &kernel : kernels)
+	{
+		INFO("Kernel " << kernel.name);
+		std::vector<crypto::sha256_t::digest_t> digests(messages.size());
+		kernel.function(messages, digests);
+		for (size_t i{}; i < messages.size(); ++i)
+			REQUIRE(digests[i] == hasher.hash(messages[i]));
+	}
+}
+#endif
@@ -1,5 +1,10 @@
 // SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
 #include <substrate/crypto/sha512>
 #include <catch2/catch_test_macros.hpp>
 
@@ -57,3 +62,129 @@ TEST_CASE("sha512: std::array<>", "[crypto/sha512]")
 
 	REQUIRE(hasher(small_input) == small_hash);
 }
+
+namespace
+{
+	crypto::sha512_t::digest_t fromHex(const char *const hex)
+	{
+		crypto::sha512_t::digest_t digest{{}};
+		for (size_t i{}; i < digest.size(); ++i)
+			digest[i] = uint8_t(std::stoul(std::string{hex + (i * 2U), 2U}, nullptr, 16));
+		return digest;
+	}
+
+	substrate::span<const uint8_t> asBytes(const std::string &str)
+	{
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		return {reinterpret_cast<const uint8_t *>(str.data()), str.size()};
+	}
+} // namespace
+
+TEST_CASE("sha512: FIPS 180 vectors", "[crypto/sha512]")
+{
+	crypto::sha512_t hasher{};
+	const std::string abc{"abc"};
+	const std::string twoBlock{"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"};
+	const std::string longer{"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"};
+
+	REQUIRE(hasher.hash(abc.data(), abc.size()) == fromHex("ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"));
+	// hash() used to overflow its block buffer on anything longer than a single block
+	REQUIRE(hasher.hash(twoBlock.data(), twoBlock.size()) == fromHex("204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c33596fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445"));
+	REQUIRE(hasher.hash(longer.data(), longer.size()) == fromHex("8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909"));
+	// The hasher must be reusable once a hash completes
+	REQUIRE(hasher.hash(abc.data(), abc.size()) == fromHex("ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"));
+}
+
+TEST_CASE("sha512: streaming", "[crypto/sha512]")
+{
+	crypto::sha512_t hasher{};
+	const std::string million(1000000U, 'a');
+	// Feed the data in odd sized pieces so the partial block buffering is exercised
+	for (size_t offset{}; offset < million.size(); offset += 997U)
+		hasher.update(asBytes(million).subspan(offset, std::min<size_t>(997U, million.size() - offset)));
+	REQUIRE(hasher.finalize() == fromHex("e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973ebde0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b"));
+
+	std::vector<uint8_t> data(384U);
+	for (size_t i{}; i < data.size(); ++i)
+		data[i] = uint8_t((i * 7U) + 3U);
+
+	// Lengths either side of where the padding and length no longer fit in the final block
+	const std::array<std::pair<size_t, const char *>, 6> vectors
+	{{
+		{111U, "68cffa6d0d76f309c9ce0d35280939f8e25990c43b7b086ccdf709be35b07d4ddba599541ff2b1c19d34ea49aeafb9659adb7ac3c0b078bb30a22d57fc6687ef"},
+		{112U, "d0865c524d1dddf7c23b799c413f5adcd7caefd3f66a9b49750ec81066012c25a8bcf94ddea6dc525691673097ca40e0101e897fc97218cfdb0704084e2bef4b"},
+		{127U, "e0b6a20f1c0c88970a9340152cd5a1c1ecf3d3b8de55102741879438079473540133b812706e5dbec322c8c9523b6fc8c6d16ee626e87ad5fe3d2916afedc369"},
+		{128U, "99b16f17aa0b969a5b8f08f367719d516e330ccd2660b6f0688ec031dbc783de50a1cd185a2568dba75070a2403d17d4741d163578515dfd2ff756ddfe4d47b1"},
+		{129U, "a1556e29185778aa5991e34b8884c840d589f0fbb4b8ed590e51e9ac4eb03a008125000db2671f8fe7f485b59a77b518670078ecb41a54b4cd02a7f1d2ca4c6d"},
+		{261U, "ba9e1e87f98d9d395062a95775a6abd1e7fb7dc1824831286347e6d2d5d9f25a95a22a3e1172370d4b6209f2f66c9b8bb76a38db46a2279e962190e8c948d5e6"},
+	}};
+	for (const auto &vector : vectors)
+	{
+		const auto expected{fromHex(vector.second)};
+		REQUIRE(hasher.hash(data.data(), vector.first) == expected);
+		for (const size_t chunk : {1U, 3U, 128U})
+		{
+			for (size_t offset{}; offset < vector.first; offset += chunk)
+				hasher.update(data.data() + offset, std::min(chunk, vector.first - offset));
+			REQUIRE(hasher.finalize() == expected);
+		}
+	}
+}
+
+#ifdef SUBSTRATE_HAVE_LIBRARY
+namespace
+{
+	// Pads and hashes message with the one compression kernel given, rather than whichever is dispatched to
+	crypto::sha512_t::digest_t hashWith(const internal::sha512Kernel_t kernel, const std::vector<uint8_t> &message)
+	{
+		std::array<uint64_t, 8> state
+		{{
+			UINT64_C(0x6A09E667F3BCC908), UINT64_C(0xBB67AE8584CAA73B), UINT64_C(0x3C6EF372FE94F82B),
+			UINT64_C(0xA54FF53A5F1D36F1), UINT64_C(0x510E527FADE682D1), UINT64_C(0x9B05688C2B3E6C1F),
+			UINT64_C(0x1F83D9ABFB41BD6B), UINT64_C(0x5BE0CD19137E2179),
+		}};
+		std::vector<uint8_t> padded{message};
+		padded.push_back(0x80U);
+		while (padded.size() % crypto::sha512_t::blockSize != 112U)
+			padded.push_back(0U);
+		// The length is 128 bits, but none of these messages need more than the low 64
+		padded.insert(padded.end(), 8U, 0U);
+		for (size_t i{8U}; i; --i)
+			padded.push_back(uint8_t((uint64_t{message.size()} << 3U) >> ((i - 1U) * 8U)));
+		kernel(state, padded.data(), padded.size() / crypto::sha512_t::blockSize);
+
+		crypto::sha512_t::digest_t digest{{}};
+		for (size_t i{}; i < digest.size(); ++i)
+			digest[i] = uint8_t(state[i / 8U] >> ((7U - (i % 8U)) * 8U));
+		return digest;
+	}
+} // namespace
+
+TEST_CASE("sha512: kernels", "[crypto/sha512]")
+{
+	std::vector<uint8_t> data(384U);
+	for (size_t i{}; i < data.size(); ++i)
+		data[i] = uint8_t((i * 7U) + 3U);
+	const std::array<std::pair<size_t, const char *>, 6> vectors
+	{{
+		{111U, "68cffa6d0d76f309c9ce0d35280939f8e25990c43b7b086ccdf709be35b07d4ddba599541ff2b1c19d34ea49aeafb9659adb7ac3c0b078bb30a22d57fc6687ef"},
+		{112U, "d0865c524d1dddf7c23b799c413f5adcd7caefd3f66a9b49750ec81066012c25a8bcf94ddea6dc525691673097ca40e0101e897fc97218cfdb0704084e2bef4b"},
+		{127U, "e0b6a20f1c0c88970a9340152cd5a1c1ecf3d3b8de55102741879438079473540133b812706e5dbec322c8c9523b6fc8c6d16ee626e87ad5fe3d2916afedc369"},
+		{128U, "99b16f17aa0b969a5b8f08f367719d516e330ccd2660b6f0688ec031dbc783de50a1cd185a2568dba75070a2403d17d4741d163578515dfd2ff756ddfe4d47b1"},
+		{129U, "a1556e29185778aa5991e34b8884c840d589f0fbb4b8ed590e51e9ac4eb03a008125000db2671f8fe7f485b59a77b518670078ecb41a54b4cd02a7f1d2ca4c6d"},
+		{261U, "ba9e1e87f98d9d395062a95775a6abd1e7fb7dc1824831286347e6d2d5d9f25a95a22a3e1172370d4b6209f2f66c9b8bb76a38db46a2279e962190e8c948d5e6"},
+	}};
+
+	// Every compression kernel this CPU can run, not only the one dispatched to, must get the right answers
+	const auto kernels{internal::sha512Kernels()};
+	REQUIRE(kernels.size() >= 1U);
+	for (const auto &kernel : kernels)
+	{
+		INFO("Kernel " << kernel.name);
+		REQUIRE(hashWith(kernel.function, {'a', 'b', 'c'}) == fromHex("ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"));
+		for (const auto &vector : vectors)
+			REQUIRE(hashWith(kernel.function, {data.begin(), data.begin() + std::ptrdiff_t(vector.first)}) ==
+				fromHex(vector.second));
+	}
+}
+#endif
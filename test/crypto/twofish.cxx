@@ -1,11 +1,292 @@
 // SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
+#include <vector>
 #include <substrate/crypto/twofish>
+#include <substrate/crypto/twofish_parallel>
+#include <substrate/buffer_utils>
+#include <substrate/span>
 #include <catch2/catch_test_macros.hpp>
 
 using namespace substrate;
 
-TEST_CASE("nya", "[crypto/twofish]")
+namespace
 {
+	using block_t = std::array<uint32_t, 4>;
 
+	block_t toBlock(const std::array<uint8_t, 16> &bytes) noexcept
+	{
+		block_t block{{}};
+		for (size_t i{}; i < block.size(); ++i)
+			block[i] = buffer_utils::readLE<uint32_t>(bytes.data() + (i * 4U));
+		return block;
+	}
+
+	constexpr std::array<uint8_t, 32> zeroKey{{}};
+	constexpr std::array<uint8_t, 32> testKey{{
+		0x01U, 0x23U, 0x45U, 0x67U, 0x89U, 0xABU, 0xCDU, 0xEFU,
+		0xFEU, 0xDCU, 0xBAU, 0x98U, 0x76U, 0x54U, 0x32U, 0x10U,
+		0x00U, 0x11U, 0x22U, 0x33U, 0x44U, 0x55U, 0x66U, 0x77U,
+		0x88U, 0x99U, 0xAAU, 0xBBU, 0xCCU, 0xDDU, 0xEEU, 0xFFU
+	}};
+
+	// From the 256-bit ECB known answer tests in the Twofish submission
+	const auto zeroKeyBlock1{toBlock({{
+		0x57U, 0xFFU, 0x73U, 0x9DU, 0x4DU, 0xC9U, 0x2CU, 0x1BU,
+		0xD7U, 0xFCU, 0x01U, 0x70U, 0x0CU, 0xC8U, 0x21U, 0x6FU
+	}})};
+	const auto zeroKeyBlock2{toBlock({{
+		0xD4U, 0x3BU, 0xB7U, 0x55U, 0x6EU, 0xA3U, 0x2EU, 0x46U,
+		0xF2U, 0xA2U, 0x82U, 0xB7U, 0xD4U, 0x5BU, 0x4EU, 0x0DU
+	}})};
+	const auto testKeyBlock{toBlock({{
+		0x37U, 0x52U, 0x7BU, 0xE0U, 0x05U, 0x23U, 0x34U, 0xB8U,
+		0x9FU, 0x0CU, 0xFCU, 0xCAU, 0xE8U, 0x7CU, 0xFAU, 0x20U
+	}})};
+} // namespace
+
+TEST_CASE("twofish: known answers", "[crypto/twofish]")
+{
+	// With an all-zero IV, the first CBC block is a raw block encryption
+	const std::array<uint8_t, 16> iv{{}};
+	const block_t zero{{}};
+	block_t result{{}};
+
+	crypto::twofish_cbc_t cipher{};
+	cipher.set_key(zeroKey);
+	cipher.set_iv(iv);
+	cipher.encrypt_blk(zero, result);
+	REQUIRE(result == zeroKeyBlock1);
+
+	cipher.set_iv(iv);
+	cipher.encrypt_blk(zeroKeyBlock1, result);
+	REQUIRE(result == zeroKeyBlock2);
+
+	cipher.set_key(testKey);
+	cipher.set_iv(iv);
+	cipher.encrypt_blk(zero, result);
+	REQUIRE(result == testKeyBlock);
+}
+
+TEST_CASE("twofish: CTR keystream", "[crypto/twofish]")
+{
+	crypto::twofish_ctr_t cipher{};
+	cipher.set_key(zeroKey);
+	cipher.set_iv(std::array<uint8_t, 8>{{}});
+	cipher.set_counter(0U);
+
+	const block_t zero{{}};
+	block_t result{{}};
+	cipher.encrypt_blk(zero, result);
+	REQUIRE(result == zeroKeyBlock1);
+}
+
+TEST_CASE("twofish: CTR bulk crypt", "[crypto/twofish]")
+{
+	crypto::twofish_ctr_t cipher{};
+	cipher.set_key(testKey);
+	cipher.set_iv(std::array<uint8_t, 8>{{0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U}});
+
+	// Builds the expected output from the block at a time CTR path
+	const auto serialCrypt{[&](const std::vector<uint8_t> &input, const uint64_t startBlock)
+	{
+		std::vector<uint8_t> output(input.size());
+		cipher.set_counter(startBlock);
+		for (size_t offset{}; offset < input.size(); offset += 16U)
+		{
+			const auto len{std::min<size_t>(16U, input.size() - offset)};
+			block_t block{{}};
+			block_t result{{}};
+			std::memcpy(block.data(), input.data() + offset, len);
+			cipher.encrypt_blk(block, result);
+			std::memcpy(output.data() + offset, result.data(), len);
+		}
+		return output;
+	}};
+
+	// Covers the interleaved, single block and partial block paths, and the threaded split of crypt_parallel()
+	for (const size_t size : {0U, 5U, 16U, 100U, 128U, 1000U, 4096U, (2U << 20U) + 37U})
+	{
+		std::vector<uint8_t> input(size);
+		for (size_t i{}; i < size; ++i)
+			input[i] = uint8_t(i * 7U);
+		const uint64_t startBlock{UINT64_C(0xFFFFFFFFFFFFFFF0)};
+
+		std::vector<uint8_t> output(size);
+		cipher.crypt(input, output, startBlock);
+		REQUIRE(output == serialCrypt(input, startBlock));
+
+		std::vector<uint8_t> roundTrip(size);
+		cipher.crypt(output, roundTrip, startBlock);
+		REQUIRE(roundTrip == input);
+
+		std::vector<uint8_t> parallel(size);
+		crypto::crypt_parallel(cipher, input, parallel, startBlock);
+		REQUIRE(parallel == output);
+	}
+
+	const block_t zero{{}};
+	block_t byIndex{{}};
+	cipher.encrypt_blk_by_idx(zero, byIndex, 42U);
+	std::array<uint8_t, 16> keystream{{}};
+	cipher.crypt(std::array<uint8_t, 16>{{}}, keystream, 42U);
+	REQUIRE(std::memcmp(byIndex.data(), keystream.data(), keystream.size()) == 0);
 }
+
+TEST_CASE("twofish: CTR streaming", "[crypto/twofish]")
+{
+	crypto::twofish_ctr_t encrypter{};
+	crypto::twofish_ctr_t decrypter{};
+	encrypter.set_key(testKey);
+	encrypter.set_iv(std::array<uint8_t, 8>{{}});
+	encrypter.set_counter(7U);
+	decrypter.set_key(testKey);
+	decrypter.set_iv(std::array<uint8_t, 8>{{}});
+	decrypter.set_counter(7U);
+
+	std::vector<uint8_t> plaintext(300U);
+	for (size_t i{}; i < plaintext.size(); ++i)
+		plaintext[i] = uint8_t(i);
+
+	// Two calls back to back must match one call over the whole buffer
+	std::vector<uint8_t> ciphertext(plaintext.size());
+	encrypter.encrypt(plaintext.data(), 160U, ciphertext.data(), 160U);
+	encrypter.encrypt(plaintext.data() + 160U, 140U, ciphertext.data() + 160U, 140U);
+	std::vector<uint8_t> expected(plaintext.size());
+	encrypter.crypt(plaintext, expected, 7U);
+	REQUIRE(ciphertext == expected);
+
+	std::vector<uint8_t> result(plaintext.size());
+	decrypter.decrypt(ciphertext.data(), ciphertext.size(), result.data(), result.size());
+	REQUIRE(result == plaintext);
+}
+
+TEST_CASE("twofish: CBC round trip", "[crypto/twofish]")
+{
+	const std::array<uint8_t, 16> iv{{
+		0x00U, 0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U,
+		0x08U, 0x09U, 0x0AU, 0x0BU, 0x0CU, 0x0DU, 0x0EU, 0x0FU
+	}};
+	const std::array<block_t, 3> plaintext{{
+		{{ 0x00000000U, 0x11111111U, 0x22222222U, 0x33333333U }},
+		{{ 0x44444444U, 0x55555555U, 0x66666666U, 0x77777777U }},
+		{{ 0x88888888U, 0x99999999U, 0xAAAAAAAAU, 0xBBBBBBBBU }},
+	}};
+
+	const auto roundTrip{[&](auto &encrypter, auto &decrypter)
+	{
+		encrypter.set_key(testKey);
+		encrypter.set_iv(iv);
+		decrypter.set_key(testKey);
+		decrypter.set_iv(iv);
+
+		for (const auto &block : plaintext)
+		{
+			block_t ciphertext{{}};
+			block_t result{{}};
+			encrypter.encrypt_blk(block, ciphertext);
+			REQUIRE(ciphertext != block);
+			decrypter.decrypt_blk(ciphertext, result);
+			REQUIRE(result == block);
+		}
+	}};
+
+	crypto::twofish_cbc_t encrypter{};
+	crypto::twofish_cbc_t decrypter{};
+	roundTrip(encrypter, decrypter);
+
+	// Odd round counts leave the halves the other way around before the output whitening
+	crypto::twofish_t<17, crypto::twofish_mode_t::CBC> oddEncrypter{};
+	crypto::twofish_t<17, crypto::twofish_mode_t::CBC> oddDecrypter{};
+	roundTrip(oddEncrypter, oddDecrypter);
+}
+
+TEST_CASE("twofish: CBC bulk decrypt", "[crypto/twofish]")
+{
+	const std::array<uint8_t, 16> iv{{
+		0xF0U, 0xE1U, 0xD2U, 0xC3U, 0xB4U, 0xA5U, 0x96U, 0x87U,
+		0x78U, 0x69U, 0x5AU, 0x4BU, 0x3CU, 0x2DU, 0x1EU, 0x0FU
+	}};
+	crypto::twofish_cbc_t encrypter{};
+	crypto::twofish_cbc_t decrypter{};
+	encrypter.set_key(testKey);
+	decrypter.set_key(testKey);
+
+	// Covers the paired, single block and (through decrypt_parallel()) threaded paths
+	for (const size_t size : {0U, 16U, 48U, 1024U, (2U << 20U) + 48U})
+	{
+		std::vector<uint8_t> plaintext(size);
+		for (size_t i{}; i < size; ++i)
+			plaintext[i] = uint8_t(i * 13U);
+		std::vector<uint8_t> ciphertext(size);
+		encrypter.set_iv(iv);
+		encrypter.encrypt(plaintext.data(), plaintext.size(), ciphertext.data(), ciphertext.size());
+
+		std::vector<uint8_t> result(size);
+		decrypter.set_iv(iv);
+		REQUIRE(decrypter.decrypt(ciphertext, result) == size);
+		REQUIRE(result == plaintext);
+
+		// In-place, and the chaining value must carry on into the next call
+		auto buffer{ciphertext};
+		decrypter.set_iv(iv);
+		const span<uint8_t> front{buffer.data(), size / 2U - ((size / 2U) % 16U)};
+		const span<uint8_t> back{buffer.data() + front.size(), size - front.size()};
+		REQUIRE(decrypter.decrypt(front, front) == front.size());
+		REQUIRE(decrypter.decrypt(back, back) == back.size());
+		REQUIRE(buffer == plaintext);
+
+		// The threaded form, fed with a held back partial block in front to make sure it carries that too
+		if (size >= 16U)
+		{
+			std::vector<uint8_t> parallel(size);
+			decrypter.set_iv(iv);
+			REQUIRE(crypto::decrypt_parallel(decrypter, span<const uint8_t>{ciphertext.data(), 5U},
+				span<uint8_t>{}) == 0U);
+			REQUIRE(crypto::decrypt_parallel(decrypter, span<const uint8_t>{ciphertext.data() + 5U, size - 5U},
+				span<uint8_t>{parallel}) == size);
+			REQUIRE(parallel == plaintext);
+		}
+	}
+}
+
+TEST_CASE("twofish: CBC streaming decrypt", "[crypto/twofish]")
+{
+	const std::array<uint8_t, 16> iv{{}};
+	crypto::twofish_cbc_t cipher{};
+	cipher.set_key(testKey);
+	cipher.set_iv(iv);
+
+	std::vector<uint8_t> plaintext(16U * 40U);
+	for (size_t i{}; i < plaintext.size(); ++i)
+		plaintext[i] = uint8_t(i);
+	std::vector<uint8_t> ciphertext(plaintext.size());
+	cipher.encrypt(plaintext.data(), plaintext.size(), ciphertext.data(), ciphertext.size());
+
+	// Feed the ciphertext in awkwardly sized reads, as a pipe or socket might hand it over
+	cipher.set_iv(iv);
+	std::vector<uint8_t> result(plaintext.size());
+	size_t produced{};
+	size_t consumed{};
+	for (size_t read{1U}; consumed < ciphertext.size(); read = (read * 7U) % 61U + 1U)
+	{
+		const auto len{std::min(read, ciphertext.size() - consumed)};
+		produced += cipher.decrypt(span<const uint8_t>{ciphertext.data() + consumed, len},
+			span<uint8_t>{result.data() + produced, result.size() - produced});
+		consumed += len;
+		REQUIRE(produced == consumed - (consumed % 16U));
+	}
+	REQUIRE(result == plaintext);
+
+	// Whole block arrays go straight through
+	cipher.set_iv(iv);
+	std::array<uint8_t, 32> blocks{{}};
+	std::copy(ciphertext.begin(), ciphertext.begin() + 32, blocks.begin());
+	std::array<uint8_t, 32> blocksResult{{}};
+	cipher.decrypt(blocks, blocksResult);
+	REQUIRE(std::equal(blocksResult.begin(), blocksResult.end(), plaintext.begin()));
+}
+
+/* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
@@ -2,12 +2,16 @@
 #include <cstring>
 #include <memory>
 #include <array>
+#include <vector>
 #include <substrate/fd>
 #include <substrate/utility>
 #include <catch2/catch_test_macros.hpp>
 
 using substrate::fd_t;
 using substrate::make_unique;
+using substrate::span;
+using substrate::readBuffers_t;
+using substrate::writeBuffers_t;
 
 constexpr static std::array<char, 4> testArray{{'t', 'E', 'S', 't'}};
 constexpr static char testChar{'.'};
@@ -194,6 +198,118 @@ TEST_CASE("fd_t read", "[fd_t]")
 	REQUIRE(file.isEOF());
 }
 
+namespace
+{
+	// Accepts at most `chunk` bytes per write, and leaves writeVec() to the one write() per buffer default
+	struct chunkedSink_t final : public substrate::advanced::writeable_t
+	{
+		mutable std::vector<uint8_t> data{};
+		size_t chunk{};
+		mutable size_t writes{};
+
+		ssize_t write(const void *const bufferPtr, const size_t bufferLen, std::nullptr_t) const noexcept final
+		{
+			++writes;
+			const auto count{std::min(bufferLen, chunk)};
+			const auto *const bytes{static_cast<const uint8_t *>(bufferPtr)};
+			data.insert(data.end(), bytes, bytes + count);
+			return ssize_t(count);
+		}
+	};
+} // namespace
+
+TEST_CASE("fd_t vectored I/O", "[fd_t]")
+{
+	const std::array<uint8_t, 4> header{{'h', 'e', 'a', 'd'}};
+	const std::array<uint8_t, 13> payload{{'v', 'e', 'c', 't', 'o', 'r', 'e', 'd', ' ', 'b', 'o', 'd', 'y'}};
+	const std::array<uint8_t, 3> trailer{{'e', 'n', 'd'}};
+	const std::array<span<const uint8_t>, 4> writeBuffers
+		{{span<const uint8_t>{header}, {}, span<const uint8_t>{payload}, span<const uint8_t>{trailer}}};
+
+	{
+		fd_t file{"fd_vec.test", O_RDWR | O_CREAT | O_TRUNC, substrate::normalMode};
+		REQUIRE(file.valid());
+		REQUIRE(file.writeVec(writeBuffers));
+		REQUIRE(file.tell() == 20);
+		// More buffers than go in one call get written across several
+		std::vector<uint8_t> bytes(100U);
+		std::vector<span<const uint8_t>> many{};
+		for (size_t i{}; i < bytes.size(); ++i)
+		{
+			bytes[i] = uint8_t(i);
+			many.emplace_back(&bytes[i], 1U);
+		}
+#ifndef _WIN32
+		REQUIRE(file.writeVec(many, nullptr) == ssize_t(substrate::internal::maxIoVecs));
+#endif
+		REQUIRE(file.head());
+		REQUIRE(file.writeVec(many));
+		REQUIRE(file.tell() == 100);
+		REQUIRE(file.head());
+		REQUIRE(file.writeVec(writeBuffers));
+	}
+
+	fd_t file{"fd_vec.test", O_RDWR};
+	REQUIRE(file.valid());
+	std::array<uint8_t, 5> first{};
+	std::array<uint8_t, 15> second{};
+	const std::array<span<uint8_t>, 3> readBuffers{{span<uint8_t>{first}, {}, span<uint8_t>{second}}};
+	REQUIRE(file.readVec(readBuffers));
+	REQUIRE(memcmp(first.data(), "headv", first.size()) == 0);
+	REQUIRE(memcmp(second.data(), "ectored bodyend", second.size()) == 0);
+	REQUIRE_FALSE(file.isEOF());
+
+#ifndef _WIN32
+	// Positional transfers leave the file position where it was
+	const auto position{file.tell()};
+	std::array<uint8_t, 3> patch{{'V', 'E', 'C'}};
+	REQUIRE(file.writeVecAt(std::array<span<const uint8_t>, 1>{{span<const uint8_t>{patch}}}, 4) == 3);
+	std::array<uint8_t, 2> a{};
+	std::array<uint8_t, 4> b{};
+	REQUIRE(file.readVecAt(std::array<span<uint8_t>, 2>{{span<uint8_t>{a}, span<uint8_t>{b}}}, 2) == 6);
+	REQUIRE(memcmp(a.data(), "ad", a.size()) == 0);
+	REQUIRE(memcmp(b.data(), "VECt", b.size()) == 0);
+	REQUIRE(file.tell() == position);
+#endif
+
+	// Reading past the end of the rest of the file comes up short, and then hits EOF
+	std::array<uint8_t, 88> rest{};
+	const std::array<span<uint8_t>, 1> restBuffers{{span<uint8_t>{rest}}};
+	REQUIRE(file.readVec(restBuffers, nullptr) == 80);
+	REQUIRE_FALSE(file.readVec(restBuffers));
+	REQUIRE(file.isEOF());
+	unlink("fd_vec.test");
+}
+
+TEST_CASE("writeable_t vectored writes across short writes", "[fd_t]")
+{
+	const std::array<uint8_t, 5> a{{1, 2, 3, 4, 5}};
+	const std::array<uint8_t, 2> b{{6, 7}};
+	const std::array<uint8_t, 7> c{{8, 9, 10, 11, 12, 13, 14}};
+	const std::array<span<const uint8_t>, 4> buffers
+		{{span<const uint8_t>{a}, span<const uint8_t>{b}, {}, span<const uint8_t>{c}}};
+
+	chunkedSink_t sink{};
+	sink.chunk = 3U;
+	// A single attempt stops at the first short write
+	REQUIRE(sink.writeVec(buffers, nullptr) == 3);
+	REQUIRE(sink.writes == 1U);
+
+	// Writing it all picks up from part way through whichever buffer the last write stopped in
+	sink.data.clear();
+	sink.writes = 0U;
+	REQUIRE(sink.writeVec(buffers));
+	REQUIRE(sink.data.size() == 14U);
+	for (size_t i{}; i < sink.data.size(); ++i)
+		REQUIRE(sink.data[i] == i + 1U);
+	REQUIRE(sink.writes == 6U);
+
+	// A sink that stops accepting anything fails the write
+	sink.chunk = 0U;
+	REQUIRE_FALSE(sink.writeVec(buffers));
+	REQUIRE(sink.writeVec(writeBuffers_t{}));
+}
+
 TEST_CASE()
 {
 	unlink("fd.test");
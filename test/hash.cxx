@@ -1,5 +1,11 @@
 // SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
 #include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #if __cplusplus < 201402L && !defined(SUBSTRATE_CXX11_COMPAT)
 #	define SUBSTRATE_CXX11_COMPAT
@@ -25,10 +31,35 @@ TEST_CASE("murmur128", "[hash]")
 	REQUIRE(pair1.second == UINT64_C(0x9F540094625E42E2));
 	REQUIRE(pair2.first == UINT64_C(0x4F31A8059DA6FD7B));
 	REQUIRE(pair2.second == UINT64_C(0xF2A28C958B8932F3));
-	REQUIRE(pair3.first == UINT64_C(0x48AF88C9CEE696BE));
-	REQUIRE(pair3.second == UINT64_C(0x56088E21F181226E));
-	REQUIRE(pair4.first == UINT64_C(0x912746B2BA9DE05));
-	REQUIRE(pair4.second == UINT64_C(0x9041FFD456E73DE0));
+	REQUIRE(pair3.first == UINT64_C(0x72F95A98AEA09385));
+	REQUIRE(pair3.second == UINT64_C(0xAF623186B80C8500));
+	REQUIRE(pair4.first == UINT64_C(0x7D28F9530F729C88));
+	REQUIRE(pair4.second == UINT64_C(0x6CD7C58A465BB646));
+
+	// Reference MurmurHash3_x64_128 output for a seed of 0
+	const auto pair5{substrate::murmur128(example, 0U)};
+	REQUIRE(pair5.first == UINT64_C(0xE34BBC7BBC071B6C));
+	REQUIRE(pair5.second == UINT64_C(0x7A433CA9C49A9347));
+}
+
+TEST_CASE("murmur128_many", "[hash]")
+{
+	static constexpr auto seed{UINT32_C(0x900DBEEF)};
+	std::vector<std::string> keys{};
+	// Cover a spread of lengths either side of the 16 byte block size
+	for (size_t i{}; i < 23U; ++i)
+		keys.emplace_back((i * 7U) % 41U, char('a' + i));
+
+	std::vector<std::pair<uint64_t, uint64_t>> hashes(keys.size());
+	substrate::murmur128_many(substrate::span<const std::string>{keys},
+		substrate::span<std::pair<uint64_t, uint64_t>>{hashes}, seed);
+	for (size_t i{}; i < keys.size(); ++i)
+		REQUIRE(hashes[i] == substrate::murmur128(keys[i], seed));
+
+	// A short output span must not quietly leave keys unhashed
+	hashes.pop_back();
+	REQUIRE_THROWS_AS(substrate::murmur128_many(substrate::span<const std::string>{keys},
+		substrate::span<std::pair<uint64_t, uint64_t>>{hashes}, seed), std::out_of_range);
 }
 
 TEST_CASE("bsd", "[hash]")
@@ -57,6 +88,75 @@ TEST_CASE("sysv", "[hash]")
 	REQUIRE(substrate::sysv_checksum(example2) == 0x1007);
 }
 
+namespace
+{
+	// The original byte-at-a-time implementation, which the vectorised and parallel versions must match
+	uint16_t sysvReference(const uint8_t *const bytes, const size_t len)
+	{
+		constexpr auto m32 = std::numeric_limits<std::uint32_t>::max();
+		constexpr auto m16 = std::numeric_limits<std::uint16_t>::max();
+		std::uint32_t sum{};
+		for (std::size_t i{}; i < len; ++i)
+			sum += bytes[i];
+		std::uint32_t res = sum % m16 + (sum % m32) / m16;
+		return std::uint16_t((res % m16) + res / m16);
+	}
+} // namespace
+
+TEST_CASE("sysv bulk consistency", "[hash]")
+{
+	std::vector<uint8_t> data(4096U);
+	for (size_t i{}; i < data.size(); ++i)
+		data[i] = uint8_t(0xFFU - (i * 7U));
+
+	for (const size_t offset : {0U, 1U, 13U, 31U})
+	{
+		for (const size_t length : {1U, 15U, 31U, 32U, 33U, 64U, 127U, 128U, 129U, 1000U, 4000U})
+			REQUIRE(substrate::sysv_checksum(data.data() + offset, length) == sysvReference(data.data() + offset, length));
+	}
+
+	substrate::sysvChecksum_t checksum{};
+	for (size_t offset{}; offset < data.size(); offset += 100U)
+		checksum.update(substrate::span<const uint8_t>{data.data() + offset, std::min<size_t>(100U, data.size() - offset)});
+	REQUIRE(checksum.finalize() == sysvReference(data.data(), data.size()));
+	REQUIRE(checksum.value() == 0U);
+}
+
+#ifdef SUBSTRATE_HAVE_LIBRARY
+TEST_CASE("sysv kernels", "[hash]")
+{
+	std::vector<uint8_t> data(4096U);
+	for (size_t i{}; i < data.size(); ++i)
+		data[i] = uint8_t(0xFFU - (i * 7U));
+
+	const auto kernels{substrate::internal::byteSumKernels()};
+	REQUIRE(kernels.size() >= 1U);
+	for (const auto &kernel : kernels)
+	{
+		INFO("Kernel " << kernel.name);
+		for (const size_t offset : {0U, 1U, 13U, 31U})
+		{
+			for (const size_t length : {1U, 15U, 31U, 32U, 33U, 64U, 127U, 128U, 129U, 1000U, 4000U})
+			{
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+				const auto *const begin{data.data() + offset};
+				REQUIRE(kernel.function(begin, length) == std::accumulate(begin, begin + length, 0U));
+			}
+		}
+	}
+}
+#endif
+
+TEST_CASE("sysv parallel", "[hash]")
+{
+	// Large enough to be split across the pool, and for the 32-bit sum to wrap
+	std::vector<uint8_t> data(24U * 1024U * 1024U + 5U, 0xFFU);
+	data[12345] = 0x01U;
+	REQUIRE(substrate::sysv_checksum_parallel(data) == sysvReference(data.data(), data.size()));
+	REQUIRE(substrate::sysv_checksum_parallel(data) == substrate::sysv_checksum(data));
+	REQUIRE(substrate::sysv_checksum_parallel(data.data(), 1000U) == sysvReference(data.data(), 1000U));
+}
+
 TEST_CASE("crc32", "[hash]")
 {
 	// https://github.com/emn178/js-crc/blob/master/README.md
@@ -71,4 +171,288 @@ TEST_CASE("crc32", "[hash]")
 	REQUIRE(substrate::crc32(example2) == UINT32_C(0x519025E9));
 }
 
+namespace
+{
+	// Bit-at-a-time reference implementation to check the table driven and accelerated paths against
+	uint32_t crcReference(const uint32_t poly, const std::vector<uint8_t> &data, const size_t offset, const size_t length)
+	{
+		uint32_t crc{UINT32_MAX};
+		for (size_t i{offset}; i < offset + length; ++i)
+		{
+			crc ^= data[i];
+			for (size_t bit{}; bit < 8U; ++bit)
+				crc = (crc >> 1U) ^ ((crc & 1U) ? poly : 0U);
+		}
+		return ~crc;
+	}
+
+	std::vector<uint8_t> makeTestData(const size_t length)
+	{
+		std::vector<uint8_t> data(length);
+		uint32_t state{UINT32_C(0x12345678)};
+		for (auto &value : data)
+		{
+			state = state * UINT32_C(1103515245) + UINT32_C(12345);
+			value = uint8_t(state >> 24U);
+		}
+		return data;
+	}
+} // namespace
+
+TEST_CASE("crc32 check value", "[hash]")
+{
+	const std::string check{"123456789"};
+	REQUIRE(substrate::crc32(check) == UINT32_C(0xCBF43926));
+}
+
+TEST_CASE("crc32 bulk consistency", "[hash]")
+{
+	const auto data{makeTestData(4096U)};
+	// Cover every alignment and the boundaries between the folding, slicing and bytewise paths
+	for (const size_t offset : {0U, 1U, 3U, 7U, 15U})
+	{
+		for (const size_t length : {0U, 1U, 15U, 16U, 17U, 63U, 64U, 65U, 127U, 128U, 200U, 1000U, 4000U})
+		{
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			REQUIRE(substrate::crc32(data.data() + offset, length) == crcReference(UINT32_C(0xEDB88320), data, offset, length));
+		}
+	}
+}
+
+TEST_CASE("crc32c", "[hash]")
+{
+	const std::string empty{};
+	const std::string check{"123456789"};
+	const std::string example{"The quick brown fox jumps over the lazy dog"};
+	const std::array<uint8_t, 32> zeros{};
+
+	REQUIRE(substrate::crc32c(empty) == UINT32_C(0x00000000));
+	REQUIRE(substrate::crc32c(check) == UINT32_C(0xE3069283));
+	REQUIRE(substrate::crc32c(example) == UINT32_C(0x22620404));
+	// RFC 3720 B.4 test vector
+	REQUIRE(substrate::crc32c(zeros) == UINT32_C(0x8A9136AA));
+
+	const auto data{makeTestData(4096U)};
+	for (const size_t offset : {0U, 1U, 5U})
+	{
+		for (const size_t length : {1U, 7U, 8U, 9U, 31U, 64U, 100U, 4000U})
+		{
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			REQUIRE(substrate::crc32c(data.data() + offset, length) == crcReference(UINT32_C(0x82F63B78), data, offset, length));
+		}
+	}
+}
+
+#ifdef SUBSTRATE_HAVE_LIBRARY
+TEST_CASE("crc32 kernels", "[hash]")
+{
+	// Every kernel this CPU can run, not just the one that gets dispatched to, has to agree with the reference
+	const auto data{makeTestData(4096U)};
+	const auto checkKernels{[&](const substrate::internal::kernels_t<substrate::internal::crcKernel_t> &kernels,
+		const uint32_t poly)
+	{
+		REQUIRE(kernels.size() >= 1U);
+		for (const auto &kernel : kernels)
+		{
+			INFO("Kernel " << kernel.name);
+			for (const size_t offset : {0U, 1U, 3U, 7U, 15U})
+			{
+				for (const size_t length : {1U, 7U, 8U, 15U, 16U, 17U, 63U, 64U, 65U, 127U, 128U, 200U, 1000U, 4000U})
+				{
+					// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+					REQUIRE(~kernel.function(UINT32_MAX, data.data() + offset, length) ==
+						crcReference(poly, data, offset, length));
+				}
+			}
+		}
+	}};
+	checkKernels(substrate::internal::crc32Kernels(), UINT32_C(0xEDB88320));
+	checkKernels(substrate::internal::crc32cKernels(), UINT32_C(0x82F63B78));
+}
+#endif
+
+TEST_CASE("crc32 streaming", "[hash]")
+{
+	const auto data{makeTestData(4096U)};
+	const auto expected{substrate::crc32(data.data(), data.size())};
+
+	substrate::crc32_t crc{};
+	REQUIRE(crc.finalize() == UINT32_C(0x00000000));
+	for (const size_t chunk : {1U, 3U, 16U, 63U, 100U, 4096U})
+	{
+		for (size_t offset{}; offset < data.size(); offset += chunk)
+		{
+			const auto length{std::min(chunk, data.size() - offset)};
+			crc.update(substrate::span<const uint8_t>{data.data() + offset, length});
+		}
+		REQUIRE(crc.value() == expected);
+		// Finalising must hand back the CRC and leave us ready for a new stream
+		REQUIRE(crc.finalize() == expected);
+		REQUIRE(crc.value() == UINT32_C(0x00000000));
+	}
+
+	substrate::crc32c_t crcc{};
+	crcc.update(data.data(), 1000U);
+	crcc.update(data.data() + 1000U, data.size() - 1000U);
+	REQUIRE(crcc.finalize() == substrate::crc32c(data.data(), data.size()));
+}
+
+TEST_CASE("crc32 combine", "[hash]")
+{
+	const auto data{makeTestData(4096U)};
+	const auto whole{substrate::crc32(data.data(), data.size())};
+	const auto wholeC{substrate::crc32c(data.data(), data.size())};
+
+	for (const size_t split : {0U, 1U, 7U, 64U, 1000U, 4095U, 4096U})
+	{
+		const auto lenB{data.size() - split};
+		const auto crcA{substrate::crc32(data.data(), split)};
+		const auto crcB{substrate::crc32(data.data() + split, lenB)};
+		REQUIRE(substrate::crc32_combine(crcA, crcB, lenB) == whole);
+
+		const auto crcCA{substrate::crc32c(data.data(), split)};
+		const auto crcCB{substrate::crc32c(data.data() + split, lenB)};
+		REQUIRE(substrate::crc32c_combine(crcCA, crcCB, lenB) == wholeC);
+	}
+}
+
+TEST_CASE("crc32 combine large lengths", "[hash]")
+{
+	// Combining with a run of zeros of CRC 0 just shifts the first CRC along, so appending n zeros
+	// and then m more must match appending n + m in one go, for lengths far past what we could hash
+	const uint32_t crc{substrate::crc32(makeTestData(64U).data(), 64U)};
+	const uint32_t crcC{substrate::crc32c(makeTestData(64U).data(), 64U)};
+	for (size_t bit{}; bit < 63U; ++bit)
+	{
+		const uint64_t half{UINT64_C(1) << bit};
+		REQUIRE(substrate::crc32_combine(substrate::crc32_combine(crc, 0U, half), 0U, half) ==
+			substrate::crc32_combine(crc, 0U, half * 2U));
+		REQUIRE(substrate::crc32c_combine(substrate::crc32c_combine(crcC, 0U, half), 0U, half) ==
+			substrate::crc32c_combine(crcC, 0U, half * 2U));
+	}
+
+	const uint64_t lenA{UINT64_C(0x123456789)};
+	const uint64_t lenB{UINT64_C(0xFEDCBA987654)};
+	REQUIRE(substrate::crc32c_combine(substrate::crc32c_combine(crcC, 0U, lenA), 0U, lenB) ==
+		substrate::crc32c_combine(crcC, 0U, lenA + lenB));
+	REQUIRE(substrate::crc32_combine(substrate::crc32_combine(crc, 0U, lenA), 0U, lenB) ==
+		substrate::crc32_combine(crc, 0U, lenA + lenB));
+}
+
+namespace
+{
+	struct xxh3Vector_t final
+	{
+		size_t length;
+		uint64_t hash64;
+		uint64_t hash128Low;
+		uint64_t hash128High;
+	};
+
+	// Generated with the reference xxHash 0.8 over the makeTestData() stream
+	const std::array<xxh3Vector_t, 26> xxh3Vectors
+	{{
+		{0U, UINT64_C(0x2D06800538D394C2), UINT64_C(0x6001C324468D497F), UINT64_C(0x99AA06D3014798D8)},
+		{1U, UINT64_C(0x4A4139CAF4136257), UINT64_C(0x4A4139CAF4136257), UINT64_C(0x885F487031A56968)},
+		{3U, UINT64_C(0x681EDB50810DD20A), UINT64_C(0x681EDB50810DD20A), UINT64_C(0x35FAE7F25188EAE5)},
+		{4U, UINT64_C(0x55AA74B3D8B19EC9), UINT64_C(0xB8BA9F06A96F264E), UINT64_C(0xDEE519DA602C0A81)},
+		{8U, UINT64_C(0xFE184B52355C3924), UINT64_C(0xFE9E7B70FF002C16), UINT64_C(0xBED386AFCFCCF4D5)},
+		{9U, UINT64_C(0xE9A9AFAB043E737E), UINT64_C(0x98A832D08BF226BA), UINT64_C(0xE772C3C0C93FB18F)},
+		{16U, UINT64_C(0x49E7332447592DF8), UINT64_C(0x5D5EC11A74962298), UINT64_C(0x94C8684F6728A988)},
+		{17U, UINT64_C(0x9B7A5F6110288400), UINT64_C(0xAADADC2816C4B054), UINT64_C(0xC14DDFD839E59BCC)},
+		{32U, UINT64_C(0x930FEBF84EF1ED43), UINT64_C(0x0D99599D7FE95C5B), UINT64_C(0xFAAC7021B83FC88D)},
+		{33U, UINT64_C(0x19EE7244C5C182A3), UINT64_C(0x70A26F8CB4B70075), UINT64_C(0xC03DCF7D9D553C82)},
+		{64U, UINT64_C(0xBA261F75CBAD729B), UINT64_C(0x0C76582B5874D62F), UINT64_C(0x1693EB5AD4468F46)},
+		{65U, UINT64_C(0xAE102EC025010D29), UINT64_C(0x49E239BD3A9766D1), UINT64_C(0x6548F5183C3C9390)},
+		{96U, UINT64_C(0x9E951647F0C740CA), UINT64_C(0xED91CD97DE0CF6EE), UINT64_C(0xF3145D520A18B895)},
+		{97U, UINT64_C(0xEECC95B8EC4855CD), UINT64_C(0xEE7756057DE969C6), UINT64_C(0xB1CF8F3340C1EAA0)},
+		{128U, UINT64_C(0x0F8CF90FDF9A0928), UINT64_C(0x161FDF3F962DEC0C), UINT64_C(0x9538E372F428282D)},
+		{129U, UINT64_C(0xF1C3F85EC4684B07), UINT64_C(0xB3610A5BFD6349AF), UINT64_C(0x9C5D63B6649BEDD9)},
+		{160U, UINT64_C(0xBD1356CC012D3A32), UINT64_C(0x28813DBD2CB4CAE7), UINT64_C(0x16B4B35C6BB6B98A)},
+		{240U, UINT64_C(0xFAB12CD0D52699DC), UINT64_C(0xBFCD96490DAF006C), UINT64_C(0xD686228A4A600967)},
+		{241U, UINT64_C(0x090CEF510357131A), UINT64_C(0x090CEF510357131A), UINT64_C(0xE5F0CD10B3E7AD58)},
+		{255U, UINT64_C(0xB893B7B84CBFB5C6), UINT64_C(0xB893B7B84CBFB5C6), UINT64_C(0x0C3E04678A16A1AA)},
+		{256U, UINT64_C(0xB94A59D076C74E52), UINT64_C(0xB94A59D076C74E52), UINT64_C(0x60BE5A726B294913)},
+		{257U, UINT64_C(0xF80F6F449BD439FE), UINT64_C(0xF80F6F449BD439FE), UINT64_C(0x3A08F21CD350E320)},
+		{1024U, UINT64_C(0xF994AE3067EC693A), UINT64_C(0xF994AE3067EC693A), UINT64_C(0x0A1711E17C35B81E)},
+		{1025U, UINT64_C(0x2E99BDDA3E5FCE7A), UINT64_C(0x2E99BDDA3E5FCE7A), UINT64_C(0xE1BBABBF8FC9F5BA)},
+		{2047U, UINT64_C(0xE8A01D1DE60D51BE), UINT64_C(0xE8A01D1DE60D51BE), UINT64_C(0xA641A4F1B635037D)},
+		{4096U, UINT64_C(0x691DB413E22CF169), UINT64_C(0x691DB413E22CF169), UINT64_C(0xFA17452B775D0E28)},
+	}};
+
+	const std::array<xxh3Vector_t, 26> xxh3SeededVectors
+	{{
+		{0U, UINT64_C(0xA2E81575ABA2A497), UINT64_C(0x38E5F17F0CA8D257), UINT64_C(0x6F7D38022CAF761F)},
+		{1U, UINT64_C(0xA106540221D5EF70), UINT64_C(0xA106540221D5EF70), UINT64_C(0xCADB84D44BD001BD)},
+		{3U, UINT64_C(0xB253CF6182045324), UINT64_C(0xB253CF6182045324), UINT64_C(0x7F3C18BE35D566CC)},
+		{4U, UINT64_C(0x81B1303B81B74668), UINT64_C(0xD898D934E94218B2), UINT64_C(0x2E962E4805DB9A7C)},
+		{8U, UINT64_C(0x3085D049933DF08D), UINT64_C(0xF68A0A51738FF984), UINT64_C(0xDD9389342502BF67)},
+		{9U, UINT64_C(0x21E6F7E62C8456BD), UINT64_C(0x14DBA08CB91012D6), UINT64_C(0xF8C9CF71B71288C2)},
+		{16U, UINT64_C(0xAAD7B524F61D546A), UINT64_C(0xF0A768E1F5C81626), UINT64_C(0x883E0894B1919CA8)},
+		{17U, UINT64_C(0x3367F0F89267C491), UINT64_C(0xDE584BBC66770343), UINT64_C(0x096BD1E7E1C1E18C)},
+		{32U, UINT64_C(0x2AD76C49FDD93D8E), UINT64_C(0x873F4FBD144D4868), UINT64_C(0xB61BA7191C2E618C)},
+		{33U, UINT64_C(0xBEDDC7B7D1231581), UINT64_C(0xFF975FABAF224D13), UINT64_C(0xB2501D118C1FF2DF)},
+		{64U, UINT64_C(0x612A60574CC674DE), UINT64_C(0x9E842A738A321A9C), UINT64_C(0x6FD2BE25B5E4537B)},
+		{65U, UINT64_C(0x386E9D78D73E87DB), UINT64_C(0x411A0B299F87E963), UINT64_C(0x68335CBBAC202138)},
+		{96U, UINT64_C(0x876E8FFC7D0FFAF2), UINT64_C(0xA0CB20FB3E6FAE13), UINT64_C(0x8D2D02B15E3C949F)},
+		{97U, UINT64_C(0x526E5735DAF8ECF1), UINT64_C(0x2BBA02511793EE47), UINT64_C(0xBE021A528A846642)},
+		{128U, UINT64_C(0x6696160D1AC328A8), UINT64_C(0x450A053191A038BC), UINT64_C(0x34A4F09A5B3A5494)},
+		{129U, UINT64_C(0xDE0A844DAC340206), UINT64_C(0x961FED115E82233A), UINT64_C(0x1F3A41E79589CDA5)},
+		{160U, UINT64_C(0x961CDA31AE11855D), UINT64_C(0x5AF2F6DBEB3CB8A7), UINT64_C(0xDD79A7DD8FCF285C)},
+		{240U, UINT64_C(0x3A9189E7CA6FB9E0), UINT64_C(0xFA0C4870F48AB846), UINT64_C(0x213D659FA370324D)},
+		{241U, UINT64_C(0x1E49606865C41C8D), UINT64_C(0x1E49606865C41C8D), UINT64_C(0x33D24F028D6B9E9A)},
+		{255U, UINT64_C(0xB256F3884AC76F36), UINT64_C(0xB256F3884AC76F36), UINT64_C(0xCB94FF758A4E08E1)},
+		{256U, UINT64_C(0x9AB1BCD5B912E187), UINT64_C(0x9AB1BCD5B912E187), UINT64_C(0xAB50A8184152D82F)},
+		{257U, UINT64_C(0x7A792F0A8FFEF624), UINT64_C(0x7A792F0A8FFEF624), UINT64_C(0xE7E9E3CAC3FEBF89)},
+		{1024U, UINT64_C(0xB815850379524465), UINT64_C(0xB815850379524465), UINT64_C(0x0465E018D17E3D6C)},
+		{1025U, UINT64_C(0x0817C7267EC1D098), UINT64_C(0x0817C7267EC1D098), UINT64_C(0xF3967BCA4C89F9A3)},
+		{2047U, UINT64_C(0xB7DE306FE0BCE492), UINT64_C(0xB7DE306FE0BCE492), UINT64_C(0x9258480B5A85BABE)},
+		{4096U, UINT64_C(0x44D40C6D9D4F92E8), UINT64_C(0x44D40C6D9D4F92E8), UINT64_C(0x2675B4310075B3A9)},
+	}};
+} // namespace
+
+TEST_CASE("xxh3", "[hash]")
+{
+	const auto data{makeTestData(4096U)};
+	const std::string empty{};
+	REQUIRE(substrate::xxh3_64(empty) == UINT64_C(0x2D06800538D394C2));
+
+	const auto check{[&](const xxh3Vector_t &vector, const uint64_t seed)
+	{
+		const std::vector<uint8_t> input{data.begin(), data.begin() + std::ptrdiff_t(vector.length)};
+		CAPTURE(vector.length, seed);
+		REQUIRE(substrate::xxh3_64(input, seed) == vector.hash64);
+		const auto hash128{substrate::xxh3_128(input, seed)};
+		REQUIRE(hash128.first == vector.hash128Low);
+		REQUIRE(hash128.second == vector.hash128High);
+	}};
+
+	for (const auto &vector : xxh3Vectors)
+		check(vector, 0U);
+	for (const auto &vector : xxh3SeededVectors)
+		check(vector, UINT64_C(0x900DBEEF));
+}
+
+TEST_CASE("xxh3 streaming", "[hash]")
+{
+	const auto data{makeTestData(4096U)};
+	for (const uint64_t seed : {UINT64_C(0), UINT64_C(0x900DBEEF)})
+	{
+		substrate::xxh3_t hash{seed};
+		// Feed the input in chunks that straddle the internal buffer and the stripe and block boundaries
+		for (const size_t length : {0U, 5U, 100U, 240U, 241U, 300U, 1024U, 1500U, 4096U})
+		{
+			for (const size_t chunk : {1U, 13U, 64U, 255U, 256U, 257U, 1000U, 4096U})
+			{
+				for (size_t offset{}; offset < length; offset += chunk)
+					hash.update(substrate::span<const uint8_t>{data.data() + offset, std::min(chunk, length - offset)});
+				const substrate::span<const uint8_t> input{data.data(), length};
+				CAPTURE(seed, length, chunk);
+				REQUIRE(hash.value64() == substrate::xxh3_64(input, seed));
+				REQUIRE(hash.finalize128() == substrate::xxh3_128(input, seed));
+			}
+		}
+	}
+}
+
 /* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
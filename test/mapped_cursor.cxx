@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: BSD-3-Clause
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <substrate/mapped_cursor>
+#include <catch2/catch_test_macros.hpp>
+
+using substrate::fd_t;
+using substrate::mmap_t;
+using substrate::mappedCursor_t;
+
+namespace
+{
+	constexpr const char *cursorFile{"mapped_cursor.test"};
+
+	uint8_t patternAt(const size_t offset) noexcept
+		{ return uint8_t(offset ^ (offset >> 8U) ^ (offset >> 16U)); }
+
+	size_t writePattern(const size_t pages)
+	{
+		const auto length{(mmap_t::offset_alignment() * pages) + 123U};
+		fd_t file{cursorFile, O_WRONLY | O_CREAT | O_TRUNC, substrate::normalMode};
+		REQUIRE(file.valid());
+		std::vector<uint8_t> data(length);
+		for (size_t i{}; i < length; ++i)
+			data[i] = patternAt(i);
+		REQUIRE(file.write(data.data(), data.size()));
+		return length;
+	}
+
+	mappedCursor_t openCursor(const size_t windowSize)
+	{
+		fd_t file{cursorFile, O_RDONLY};
+		REQUIRE(file.valid());
+		return {std::move(file), windowSize};
+	}
+} // namespace
+
+TEST_CASE("mappedCursor_t sequential scan", "[mappedCursor_t]")
+{
+	const auto alignment{mmap_t::offset_alignment()};
+	const auto length{writePattern(10U)};
+	auto cursor{openCursor(alignment + 1U)};
+	REQUIRE(cursor.valid());
+	// The window is rounded up to whole pages
+	REQUIRE(cursor.windowSize() == alignment * 2U);
+	REQUIRE(cursor.length() == off_t(length));
+	REQUIRE_FALSE(cursor.mapping().valid());
+
+	// Records that straddle window boundaries still come back in one piece
+	constexpr size_t recordSize{24U};
+	size_t offset{};
+	while (!cursor.isEOF())
+	{
+		const auto record{cursor.view(recordSize)};
+		REQUIRE(record.size() == std::min(recordSize, length - offset));
+		for (size_t i{}; i < record.size(); ++i)
+			REQUIRE(record[i] == patternAt(offset + i));
+		// The mapping never grows past two windows, however far into the file we get
+		REQUIRE(cursor.mapping().length() <= cursor.windowSize() * 2U);
+		REQUIRE(cursor.advance(recordSize) == record.size());
+		offset += record.size();
+		REQUIRE(cursor.position() == off_t(offset));
+	}
+	REQUIRE(offset == length);
+	REQUIRE(cursor.view(1U).empty());
+	REQUIRE(cursor.advance(1U) == 0U);
+	static_cast<void>(unlink(cursorFile));
+}
+
+TEST_CASE("mappedCursor_t whole views", "[mappedCursor_t]")
+{
+	const auto alignment{mmap_t::offset_alignment()};
+	const auto length{writePattern(7U)};
+	auto cursor{openCursor(alignment * 2U)};
+
+	// A bare view() covers everything that's mapped, which is always at least a window
+	size_t offset{};
+	while (!cursor.isEOF())
+	{
+		const auto data{cursor.view()};
+		REQUIRE(data.size() >= std::min(cursor.windowSize(), length - offset));
+		REQUIRE(data.size() <= cursor.windowSize() * 2U);
+		REQUIRE(data[0] == patternAt(offset));
+		REQUIRE(data[data.size() - 1U] == patternAt(offset + data.size() - 1U));
+		// Only consume part of it, so the next view starts part way through a page
+		const auto step{std::min(data.size(), cursor.windowSize() + 100U)};
+		REQUIRE(cursor.advance(step) == step);
+		offset += step;
+	}
+	REQUIRE(offset == length);
+
+	// Seeking backwards maps the earlier part of the file again
+	REQUIRE(cursor.seek(off_t(alignment + 5U)));
+	const auto data{cursor.view(8U)};
+	REQUIRE(data.size() == 8U);
+	for (size_t i{}; i < data.size(); ++i)
+		REQUIRE(data[i] == patternAt(alignment + 5U + i));
+	REQUIRE(cursor.mapping().length() == cursor.windowSize() * 2U);
+	REQUIRE_FALSE(cursor.seek(-1));
+	REQUIRE_FALSE(cursor.seek(off_t(length + 1U)));
+	REQUIRE(cursor.seek(off_t(length)));
+	REQUIRE(cursor.isEOF());
+	static_cast<void>(unlink(cursorFile));
+}
+
+TEST_CASE("mappedCursor_t empty and invalid files", "[mappedCursor_t]")
+{
+	mappedCursor_t invalid{};
+	REQUIRE_FALSE(invalid.valid());
+	REQUIRE(invalid.isEOF());
+	REQUIRE(invalid.view().empty());
+
+	{
+		fd_t file{cursorFile, O_WRONLY | O_CREAT | O_TRUNC, substrate::normalMode};
+		REQUIRE(file.valid());
+	}
+	auto cursor{openCursor(mappedCursor_t::defaultWindowSize)};
+	REQUIRE(cursor.valid());
+	REQUIRE(cursor.length() == 0);
+	REQUIRE(cursor.isEOF());
+	REQUIRE(cursor.view(16U).empty());
+	REQUIRE_FALSE(cursor.mapping().valid());
+	static_cast<void>(unlink(cursorFile));
+}
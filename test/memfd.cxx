@@ -1,4 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
+#include <cerrno>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -179,4 +180,40 @@ TEST_CASE("memfd_t read", "[memfd_t]")
 	REQUIRE_FALSE(file.read(junk));
 	REQUIRE(file.isEOF());
 }
+
+TEST_CASE("memfd_t huge pages", "[memfd_t]")
+{
+	const auto pageSize{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+	REQUIRE(file.pageSize() == pageSize);
+
+	// Falls back to normal pages when the huge page pool can't cover it, so this always works
+	memfd_t<substrate::hugePageSize2MiB> huge{"memfd.huge", MFD_CLOEXEC, substrate::hugePageSize2MiB};
+	REQUIRE(huge.valid());
+	const auto backing{huge.pageSize()};
+	REQUIRE((backing == substrate::hugePageSize2MiB || backing == pageSize));
+	REQUIRE(size_t(huge.stat().st_size) == substrate::hugePageSize2MiB);
+	// On huge pages the file can only be filled in through a mapping
+	errno = 0;
+	if (backing == substrate::hugePageSize2MiB)
+	{
+		REQUIRE_FALSE(huge.write(u32));
+		REQUIRE(errno == EINVAL);
+	}
+	else
+	{
+		REQUIRE(huge.write(u32));
+		REQUIRE(huge.head());
+	}
+	// Mapping hands the descriptor over to the mapping
+	auto map{huge.map(PROT_READ | PROT_WRITE)};
+	REQUIRE(map.valid());
+	REQUIRE(map.page_size() == backing);
+	*map.address<uint8_t>() = 0x5AU;
+	REQUIRE(*map.address<uint8_t>() == 0x5AU);
+
+	// Sizes that aren't a whole number of huge pages go straight to normal pages
+	memfd_t<4096> small{"memfd.small", MFD_CLOEXEC, substrate::hugePageSize2MiB};
+	REQUIRE(small.valid());
+	REQUIRE(small.pageSize() == pageSize);
+}
 /* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
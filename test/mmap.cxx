@@ -9,6 +9,7 @@
 
 #include <catch2/catch_test_macros.hpp>
 #include <cstring>
+#include <vector>
 
 using substrate::mmap_t;
 using namespace substrate::constants;
@@ -119,4 +120,147 @@ TEST_CASE("Structure serialization and loading", "[mmap_t]")
 		// REQUIRE(std::memcmp(_d, &d, sizeof(foo_t)) == 0);
 	}
 }
+
+TEST_CASE("Offset mapping", "[mmap_t]")
+{
+	const auto alignment{mmap_t::offset_alignment()};
+	REQUIRE(alignment >= 4096U);
+	REQUIRE((alignment & (alignment - 1U)) == 0U);
+	{
+		fd_t file{"mmap_t.offset", O_RDWR | O_CREAT | O_TRUNC | O_NOCTTY, substrate::normalMode};
+		REQUIRE(file.valid());
+		for (size_t i{}; i < alignment * 3U; ++i)
+			REQUIRE(file.write(uint8_t(i / alignment + i)));
+	}
+
+	fd_t file{"mmap_t.offset", O_RDONLY | O_NOCTTY};
+	REQUIRE(file.valid());
+	// Map the middle of the file on its own, starting on an aligned boundary; each mapping owns its descriptor
+	fd_t middle{file.dup()};
+	mmap_t map{middle, off_t(alignment), alignment + 16U, PROT_READ, MAP_SHARED};
+	middle.invalidate();
+	REQUIRE(map.valid());
+	REQUIRE(map.length() == alignment + 16U);
+	const auto *const data{map.address<uint8_t>()};
+	for (size_t i{}; i < map.length(); ++i)
+		REQUIRE(data[i] == uint8_t((i + alignment) / alignment + i + alignment));
+
+	// Offsets that aren't aligned can't be mapped
+	fd_t unaligned{file.dup()};
+	const mmap_t misaligned{unaligned, off_t(alignment / 2U), 16U, PROT_READ, MAP_SHARED};
+	unaligned.invalidate();
+	REQUIRE_FALSE(misaligned.valid());
+	map = {};
+	static_cast<void>(unlink("mmap_t.offset"));
+}
+
+#ifndef _WIN32
+TEST_CASE("Huge page mapping", "[mmap_t]")
+{
+	const auto pageSize{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+	const mmap_t normal{-1, pageSize * 4U, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS};
+	REQUIRE(normal.valid());
+	REQUIRE(normal.page_size() == pageSize);
+	REQUIRE(normal.transparent_huge_bytes() == 0U);
+
+	REQUIRE_FALSE(mmap_t::huge(0U, PROT_READ | PROT_WRITE).valid());
+	REQUIRE_FALSE(mmap_t::huge(4096U, PROT_READ | PROT_WRITE, 3U * 1024U * 1024U).valid());
+
+	// Whether the huge page pool has anything in it or not, this gives a usable, huge page aligned mapping
+	auto map{mmap_t::huge(hugePageSize2MiB + 1U, PROT_READ | PROT_WRITE)};
+	REQUIRE(map.valid());
+	REQUIRE(map.length() == hugePageSize2MiB * 2U);
+	REQUIRE(map.numeric_address() % hugePageSize2MiB == 0U);
+	auto *const data{map.address<uint8_t>()};
+	for (size_t offset{}; offset < map.length(); offset += pageSize)
+		data[offset] = uint8_t(offset / pageSize);
+	for (size_t offset{}; offset < map.length(); offset += pageSize)
+		REQUIRE(data[offset] == uint8_t(offset / pageSize));
+
+	// Either it's on huge pages proper, or normal pages that transparent huge pages may (or may not) back
+	const auto backing{map.page_size()};
+	REQUIRE((backing == hugePageSize2MiB || backing == pageSize));
+	if (backing == hugePageSize2MiB)
+		REQUIRE(map.transparent_huge_bytes() == 0U);
+	else
+		REQUIRE(map.transparent_huge_bytes() <= map.length());
+}
+
+#ifdef SUBSTRATE_HAVE_LIBRARY
+TEST_CASE("Eager population", "[mmap_t]")
+{
+	const auto pageSize{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+	REQUIRE_FALSE(substrate::internal::populate(nullptr, pageSize, substrate::populateMode_t::read, {}));
+	const mmap_t invalid{};
+	REQUIRE_FALSE(invalid.populate());
+
+	// Big enough to be split across several workers
+	const size_t length{(40U * 1024U * 1024U) + (pageSize * 3U)};
+	mmap_t map{-1, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS};
+	REQUIRE(map.valid());
+	auto *const data{map.address<uint8_t>()};
+	data[0] = 0x5AU;
+	data[length - 1U] = 0xA5U;
+
+	std::vector<size_t> progress{};
+	REQUIRE(map.populate(substrate::populateMode_t::write, [&](const size_t done, const size_t total)
+	{
+		REQUIRE(total == length);
+		progress.push_back(done);
+	}));
+	// Progress only ever goes forwards, and finishes with everything done
+	REQUIRE(progress.size() > 1U);
+	for (size_t i{1U}; i < progress.size(); ++i)
+		REQUIRE(progress[i] > progress[i - 1U]);
+	REQUIRE(progress.back() == length);
+	// Populating doesn't disturb what's already there
+	REQUIRE(data[0] == 0x5AU);
+	REQUIRE(data[length - 1U] == 0xA5U);
+	REQUIRE(data[length / 2U] == 0U);
+#ifdef __linux__
+	std::vector<unsigned char> resident(length / pageSize);
+	REQUIRE(mincore(data, length, resident.data()) == 0);
+	for (const auto page : resident)
+		REQUIRE(page & 1U);
+#endif
+
+	// Populating a shared mapping for writing leaves what's in it alone too
+	{
+		mmap_t shared{-1, pageSize * 4U, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS};
+		REQUIRE(shared.valid());
+		auto *const bytes{shared.address<uint8_t>()};
+		for (size_t i{}; i < shared.length(); i += pageSize)
+			bytes[i] = uint8_t(i / pageSize + 1U);
+		REQUIRE(shared.populate(substrate::populateMode_t::write));
+		for (size_t i{}; i < shared.length(); i += pageSize)
+			REQUIRE(bytes[i] == uint8_t(i / pageSize + 1U));
+	}
+
+	// A mapping that can't be written can't be populated for writing, but can still be read in
+	{
+		const mmap_t readOnly{-1, pageSize * 4U, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS};
+		REQUIRE(readOnly.valid());
+		REQUIRE_FALSE(readOnly.populate(substrate::populateMode_t::write));
+		REQUIRE(readOnly.populate());
+	}
+
+	// File mappings populate for reading as well, without any progress reporting
+	{
+		fd_t file{"mmap_t.populate", O_RDWR | O_CREAT | O_TRUNC | O_NOCTTY, substrate::normalMode};
+		REQUIRE(file.valid());
+		for (size_t i{}; i < pageSize * 3U; ++i)
+			REQUIRE(file.write(uint8_t(i)));
+	}
+	fd_t file{"mmap_t.populate", O_RDONLY | O_NOCTTY};
+	REQUIRE(file.valid());
+	auto fileMap{file.map(PROT_READ, MAP_SHARED | MAP_POPULATE)};
+	REQUIRE(fileMap.valid());
+	REQUIRE(fileMap.populate());
+	for (size_t i{}; i < fileMap.length(); ++i)
+		REQUIRE(fileMap.address<uint8_t>()[i] == uint8_t(i));
+	fileMap = {};
+	static_cast<void>(unlink("mmap_t.populate"));
+}
+#endif
+#endif
 /* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
@@ -1,12 +1,505 @@
 // SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <random>
+#include <vector>
 
 #if __cplusplus < 201402L && !defined(SUBSTRATE_CXX11_COMPAT)
 #	define SUBSTRATE_CXX11_COMPAT
 #endif
 #include <substrate/prng>
+#include <substrate/thread_pool>
 #include <catch2/catch_test_macros.hpp>
 
+using namespace substrate;
 
+namespace
+{
+	template<typename prng_t, typename result_t> void checkJumps(const prng_t &rng,
+		const std::array<result_t, 2> &jumped, const std::array<result_t, 2> &longJumped)
+	{
+		auto jump{rng};
+		jump.jump();
+		REQUIRE(jump() == jumped[0]);
+		REQUIRE(jump() == jumped[1]);
+
+		auto longJump{rng};
+		longJump.long_jump();
+		REQUIRE(longJump() == longJumped[0]);
+		REQUIRE(longJump() == longJumped[1]);
+	}
+} // namespace
+
+// The expected outputs come from running the reference jump() and long_jump() from prng.di.unimi.it
+TEST_CASE("xoshiro/xoroshiro jump()", "[prng]")
+{
+	checkJumps(xoshiro128pp_t{{{1U, 2U, 3U, 4U}}},
+		std::array<uint32_t, 2>{{0xba8c0ddcU, 0x06a228ceU}}, std::array<uint32_t, 2>{{0x99cc2935U, 0x7f4f19b6U}});
+	checkJumps(xoroshiro128p_t{{{1U, 2U}}},
+		std::array<uint64_t, 2>{{UINT64_C(0xea081299d29ad927), UINT64_C(0xdde2899549f899c8)}},
+		std::array<uint64_t, 2>{{UINT64_C(0x6786a13daa9b187d), UINT64_C(0xe6c8f691b4e837bd)}});
+	checkJumps(xoroshiro128pp_t{{{1U, 2U}}},
+		std::array<uint64_t, 2>{{UINT64_C(0x6115ff4c07d8c03e), UINT64_C(0xf4564a51c7eab4b9)}},
+		std::array<uint64_t, 2>{{UINT64_C(0xbb077da55888837c), UINT64_C(0x3fd58ef899113160)}});
+	checkJumps(xoshiro256ss_t{{{1U, 2U, 3U, 4U}}},
+		std::array<uint64_t, 2>{{UINT64_C(0xbbd2f312298443d8), UINT64_C(0x62e57db2d5706577)}},
+		std::array<uint64_t, 2>{{UINT64_C(0x527752a1d792704d), UINT64_C(0xd8d8bdec57599e64)}});
+	checkJumps(xoshiro512pp_t{{{1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U}}},
+		std::array<uint64_t, 2>{{UINT64_C(0xb86339b7fc03fec0), UINT64_C(0xaa2dcb4cfd5495e3)}},
+		std::array<uint64_t, 2>{{UINT64_C(0xc5f80dd699c67e82), UINT64_C(0x795cfe51f6861a99)}});
+
+	// Step xoroshiro1024 a few times first so the jump has to cope with the rotating index
+	xoroshiro1024pp_t rng{{{1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U, 16U}}};
+	rng.discard(3U);
+	checkJumps(rng,
+		std::array<uint64_t, 2>{{UINT64_C(0x9a3f0b8a011e1ac1), UINT64_C(0xfbd81f620c0290f2)}},
+		std::array<uint64_t, 2>{{UINT64_C(0x3087eb7b309859b6), UINT64_C(0xdcc080661956d64f)}});
+}
+
+TEST_CASE("make_streams()", "[prng]")
+{
+	const xoshiro256pp_t rng{{{1U, 2U, 3U, 4U}}};
+	REQUIRE(make_streams(rng, 0U).empty());
+
+	auto streams{make_streams(rng, 4U)};
+	REQUIRE(streams.size() == 4U);
+	auto expected{rng};
+	for (auto &stream : streams)
+	{
+		auto copy{expected};
+		REQUIRE(stream() == copy());
+		REQUIRE(stream() == copy());
+		expected.jump();
+	}
+}
+
+namespace
+{
+	template<typename prng_t> void checkSplitmixSeek(const prng_t &rng)
+	{
+		for (const size_t distance : {0U, 1U, 2U, 255U, 256U, 1000U, 65537U})
+		{
+			auto stepped{rng};
+			for (size_t i{}; i < distance; ++i)
+				SUBSTRATE_NOWARN_UNUSED(const auto value) = stepped();
+			auto skipped{rng};
+			skipped.discard(distance);
+			REQUIRE(rng.at(distance) == stepped());
+			REQUIRE(skipped() == rng.at(distance));
+			REQUIRE(skipped() == stepped());
+		}
+	}
+
+	struct sampleJob_t final
+	{
+		const splitmix64_t *rng;
+		size_t begin;
+		size_t end;
+		double *samples;
+	};
+
+	bool sampleWorker(sampleJob_t *const job)
+	{
+		const uniform_real_t<double> unit{};
+		for (auto index{job->begin}; index < job->end; ++index)
+		{
+			// A generator seeded from the index'th value gives every sample its own reproducible stream
+			splitmix64_t sampleRng{job->rng->at(index)};
+			job->samples[index] = unit(sampleRng);
+		}
+		return true;
+	}
+} // namespace
+
+TEST_CASE("splitmix_t discard() and at()", "[prng]")
+{
+	checkSplitmixSeek(splitmix64_t{UINT64_C(0x0123456789ABCDEF)});
+	checkSplitmixSeek(splitmix32_t{0x89ABCDEFU});
+	checkSplitmixSeek(splitmix16_t{0xCDEFU});
+
+	// Skipping wraps around the Weyl sequence exactly as stepping does
+	splitmix64_t rng{1U};
+	rng.discard(SIZE_MAX);
+	REQUIRE(rng() == splitmix64_t{1U}.at(SIZE_MAX));
+	const splitmix16_t small{7U};
+	REQUIRE(small.at(65535U) == small.at(65535U + 65536U));
+}
+
+TEST_CASE("splitmix_t parallel sampling", "[prng]")
+{
+	const splitmix64_t rng{42U};
+	constexpr size_t count{100000U};
+	std::vector<double> expected(count);
+	sampleJob_t serial{&rng, 0U, count, expected.data()};
+	REQUIRE(sampleWorker(&serial));
+
+	// However the indices are cut up and whichever worker gets them, the samples come out the same
+	for (const size_t jobLength : {size_t{997U}, size_t{10000U}, count})
+	{
+		std::vector<double> samples(count);
+		std::vector<sampleJob_t> jobs{};
+		for (size_t begin{}; begin < count; begin += jobLength)
+			jobs.push_back({&rng, begin, std::min(begin + jobLength, count), samples.data()});
+		threadPool_t<bool (sampleJob_t *)> pool{sampleWorker};
+		for (auto &job : jobs)
+			SUBSTRATE_NOWARN_UNUSED(const auto result) = pool.queue(&job);
+		SUBSTRATE_NOWARN_UNUSED(const auto result) = pool.finish();
+		REQUIRE(samples == expected);
+	}
+}
+
+namespace
+{
+	// The documented lane order, spelt out with eight ordinary generators
+	template<typename T> std::vector<uint64_t> referenceLanes(const std::array<uint64_t, 4> &seed,
+		const size_t count)
+	{
+		auto lanes{make_streams(xoshiro256_t<T>{seed}, 8U)};
+		std::vector<uint64_t> values(count);
+		for (size_t i{}; i < count; ++i)
+			values[i] = lanes[i % 8U]();
+		return values;
+	}
+
+	template<typename T> void checkLanes()
+	{
+		constexpr std::array<uint64_t, 4> seed{{1U, 2U, 3U, 4U}};
+		const auto expected{referenceLanes<T>(seed, 1000U)};
+
+		xoshiro256x8_t<T> oneGo{seed};
+		std::vector<uint64_t> values(expected.size());
+		oneGo.fill(values);
+		REQUIRE(values == expected);
+
+		// Splitting the output up any which way between fill() and operator() must not change it
+		xoshiro256x8_t<T> pieces{seed};
+		std::vector<uint64_t> pieced{};
+		size_t step{1U};
+		while (pieced.size() < expected.size())
+		{
+			const auto count{std::min(step, expected.size() - pieced.size())};
+			if (step % 3U == 0U)
+			{
+				for (size_t i{}; i < count; ++i)
+					pieced.push_back(pieces());
+			}
+			else
+			{
+				std::vector<uint64_t> chunk(count);
+				pieces.fill(chunk);
+				pieced.insert(pieced.end(), chunk.begin(), chunk.end());
+			}
+			step += 4U;
+		}
+		REQUIRE(pieced == expected);
+	}
+} // namespace
+
+TEST_CASE("xoshiro256x8_t fill()", "[prng]")
+{
+	checkLanes<prng_type::plus_t>();
+	checkLanes<prng_type::plusplus_t>();
+	checkLanes<prng_type::starstar_t>();
+}
+
+TEST_CASE("xoshiro256x8_t fillBytes()", "[prng]")
+{
+	constexpr std::array<uint64_t, 4> seed{{5U, 6U, 7U, 8U}};
+	const auto expected{referenceLanes<prng_type::plusplus_t>(seed, 200U)};
+
+	// Bytes come out little endian, with a value cut short by the end of the span dropping its top bytes
+	for (const size_t length : {3U, 8U, 64U, 131U, 1000U})
+	{
+		xoshiro256x8pp_t rng{seed};
+		// Start partway through a block so every path gets used
+		SUBSTRATE_NOWARN_UNUSED(const auto value) = rng();
+		std::vector<uint8_t> bytes(length);
+		rng.fillBytes(bytes);
+		for (size_t i{}; i < length; ++i)
+			REQUIRE(bytes[i] == uint8_t(expected[1U + (i / 8U)] >> ((i % 8U) * 8U)));
+		REQUIRE(rng() == expected[1U + ((length + 7U) / 8U)]);
+	}
+}
+
+namespace
+{
+	// A generator's fill() and fillBytes() must give the values of calling it directly
+	template<typename prng_t> void checkScalarFill(const prng_t &seeded)
+	{
+		using result_t = typename prng_t::result_type;
+		for (const size_t count : {0U, 1U, 5U, 64U, 131U})
+		{
+			auto direct{seeded};
+			auto filled{seeded};
+			std::vector<result_t> values(count);
+			filled.fill(values);
+			for (const auto value : values)
+				REQUIRE(value == direct());
+			REQUIRE(filled() == direct());
+		}
+
+		// Bytes come out little endian, with a value cut short by the end of the span dropping its top bytes
+		for (const size_t length : {0U, 1U, 3U, 8U, 131U})
+		{
+			auto direct{seeded};
+			auto filled{seeded};
+			std::vector<uint8_t> bytes(length);
+			filled.fillBytes(bytes);
+			for (size_t offset{}; offset < length; offset += sizeof(result_t))
+			{
+				const auto value{direct()};
+				for (size_t i{}; i < sizeof(result_t) && offset + i < length; ++i)
+					REQUIRE(bytes[offset + i] == uint8_t(value >> (i * 8U)));
+			}
+			REQUIRE(filled() == direct());
+		}
+	}
+} // namespace
+
+TEST_CASE("scalar generator fill()", "[prng]")
+{
+	checkScalarFill(splitmix64_t{1U});
+	checkScalarFill(splitmix32_t{2U});
+	checkScalarFill(splitmix16_t{3U});
+	checkScalarFill(xoroshiro64ss_t{{{1U, 2U}}});
+	checkScalarFill(xoshiro128pp_t{{{1U, 2U, 3U, 4U}}});
+	checkScalarFill(xoroshiro128pp_t{{{1U, 2U}}});
+	checkScalarFill(xoshiro256ss_t{{{1U, 2U, 3U, 4U}}});
+	checkScalarFill(xoshiro512pp_t{{{1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U}}});
+	checkScalarFill(xoroshiro1024s_t{{{1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U, 16U}}});
+}
+
+TEST_CASE("UniformRandomBitGenerator interface", "[prng]")
+{
+	static_assert(xoshiro256pp_t::min() == 0U && xoshiro256pp_t::max() == UINT64_MAX, "");
+	static_assert(xoshiro128pp_t::max() == UINT32_MAX, "");
+	static_assert(std::is_same<xoroshiro64s_t::result_type, uint32_t>::value, "");
+	static_assert(std::is_same<xoshiro256x8pp_t::result_type, uint64_t>::value, "");
+	static_assert(splitmix16_t::max() == UINT16_MAX, "");
+
+	// The standard distributions and algorithms take the generators directly
+	xoshiro256pp_t rng{{{1U, 2U, 3U, 4U}}};
+	std::uniform_int_distribution<int> dice{1, 6};
+	for (size_t i{}; i < 100U; ++i)
+	{
+		const auto roll{dice(rng)};
+		REQUIRE(roll >= 1);
+		REQUIRE(roll <= 6);
+	}
+	std::vector<int> values{1, 2, 3, 4, 5, 6, 7, 8};
+	std::shuffle(values.begin(), values.end(), rng);
+	std::sort(values.begin(), values.end());
+	REQUIRE(values == std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8});
+	xoshiro128pp_t rng32{{{1U, 2U, 3U, 4U}}};
+	REQUIRE(std::generate_canonical<double, 53>(rng32) < 1.0);
+}
+
+TEST_CASE("bounded()", "[prng]")
+{
+	xoshiro256pp_t rng{{{1U, 2U, 3U, 4U}}};
+	auto reference{rng};
+	// With no rejection the result is just the high half of the product
+	const uint64_t bound{1000U};
+	REQUIRE(bounded(rng, bound) == uint64_t((static_cast<long double>(reference()) * bound) / 18446744073709551616.0L));
+
+	REQUIRE(bounded(rng, uint64_t{1U}) == 0U);
+	REQUIRE(bounded(rng, uint32_t{1U}) == 0U);
+	const uint64_t huge{(UINT64_C(1) << 63U) + 1U};
+	for (size_t i{}; i < 1000U; ++i)
+	{
+		REQUIRE(bounded(rng, huge) < huge);
+		REQUIRE(bounded(rng, uint32_t{7U}) < 7U);
+	}
+
+	// A bound just over half the range rejects nearly half of all draws, so a count of the low and high
+	// halves of the results shows up any bias towards the small values
+	size_t low{};
+	const uint32_t bound32{(UINT32_C(1) << 31U) + (UINT32_C(1) << 30U)};
+	for (size_t i{}; i < 100000U; ++i)
+	{
+		if (bounded(rng, bound32) < bound32 / 2U)
+			++low;
+	}
+	REQUIRE(low > 49000U);
+	REQUIRE(low < 51000U);
+}
+
+TEST_CASE("bounded_t", "[prng]")
+{
+	const bounded_t<uint32_t> dice{6U};
+	REQUIRE(dice.bound() == 6U);
+	xoshiro256pp_t rng{{{1U, 2U, 3U, 4U}}};
+	auto copy{rng};
+	std::array<size_t, 6> counts{};
+	for (size_t i{}; i < 60000U; ++i)
+	{
+		const auto roll{dice(rng)};
+		REQUIRE(roll == bounded(copy, uint32_t{6U}));
+		++counts[roll];
+	}
+	for (const auto count : counts)
+	{
+		REQUIRE(count > 9500U);
+		REQUIRE(count < 10500U);
+	}
+
+	// Works with the standard generators too, including mt19937's 32-bit values in a wider result_type
+	std::mt19937 twister{1U};
+	const bounded_t<uint64_t> large{UINT64_C(1) << 40U};
+	for (size_t i{}; i < 100U; ++i)
+		REQUIRE(large(twister) < (UINT64_C(1) << 40U));
+}
+
+namespace
+{
+	// fill() must give the same values as calling the distribution, for both scalar and bulk generators
+	template<typename distribution_t, typename value_t> void checkFill(const distribution_t &distribution)
+	{
+		constexpr std::array<uint64_t, 4> seed{{9U, 8U, 7U, 6U}};
+		for (const size_t count : {0U, 1U, 7U, 64U, 65U, 1000U})
+		{
+			xoshiro256x8pp_t bulk{seed};
+			xoshiro256x8pp_t single{seed};
+			std::vector<value_t> values(count);
+			distribution.fill(bulk, values);
+			for (const auto value : values)
+				REQUIRE(value == distribution(single));
+			REQUIRE(bulk() == single());
+
+			// Scalar 64-bit generators have a fill() too, but are drawn from directly
+			xoshiro256pp_t scalar{seed};
+			auto scalarCopy{scalar};
+			distribution.fill(scalar, values);
+			for (const auto value : values)
+				REQUIRE(value == distribution(scalarCopy));
+			REQUIRE(scalar() == scalarCopy());
+
+			xoshiro128pp_t narrow{{{1U, 2U, 3U, 4U}}};
+			auto narrowCopy{narrow};
+			distribution.fill(narrow, values);
+			for (const auto value : values)
+				REQUIRE(value == distribution(narrowCopy));
+		}
+	}
+
+	// A "generator" stuck on one value, for feeding the distributions chosen bit patterns
+	struct fixed_t final
+	{
+		uint64_t value;
+
+		using result_type = uint64_t;
+		constexpr static uint64_t min() noexcept { return 0U; }
+		constexpr static uint64_t max() noexcept { return UINT64_MAX; }
+		uint64_t operator()() const noexcept { return value; }
+	};
+
+	template<typename T> std::pair<double, double> moments(const std::vector<T> &values)
+	{
+		double sum{};
+		double squares{};
+		for (const auto value : values)
+		{
+			sum += double(value);
+			squares += double(value) * double(value);
+		}
+		const auto mean{sum / double(values.size())};
+		return {mean, (squares / double(values.size())) - (mean * mean)};
+	}
+} // namespace
+
+TEST_CASE("distribution fill()", "[prng]")
+{
+	checkFill<bounded_t<uint64_t>, uint64_t>(bounded_t<uint64_t>{(UINT64_C(1) << 63U) + 1U});
+	checkFill<bounded_t<uint32_t>, uint32_t>(bounded_t<uint32_t>{100U});
+	checkFill<uniform_real_t<double>, double>({});
+	checkFill<uniform_real_t<float>, float>({});
+	checkFill<normal_t<double>, double>(normal_t<double>{});
+	checkFill<normal_t<float>, float>(normal_t<float>{});
+	checkFill<exponential_t<double>, double>(exponential_t<double>{});
+}
+
+TEST_CASE("uniform_real_t", "[prng]")
+{
+	xoshiro256pp_t rng{{{1U, 2U, 3U, 4U}}};
+	auto reference{rng};
+	const uniform_real_t<double> unit{};
+	REQUIRE(unit(rng) == std::ldexp(double(reference() >> 11U), -53));
+	const uniform_real_t<float> unitFloat{};
+	REQUIRE(unitFloat(rng) == std::ldexp(float(reference() >> 40U), -24));
+
+	// The extremes of the raw bits land on 0 and the largest value below 1
+	fixed_t lowest{0U};
+	fixed_t highest{UINT64_MAX};
+	REQUIRE(unit(lowest) == 0.0);
+	REQUIRE(unit(highest) == std::nextafter(1.0, 0.0));
+	REQUIRE(unitFloat(highest) == std::nextafter(1.0F, 0.0F));
+
+	std::vector<double> values(100000U);
+	xoshiro256x8pp_t bulk{std::array<uint64_t, 4>{{1U, 2U, 3U, 4U}}};
+	unit.fill(bulk, values);
+	REQUIRE(*std::min_element(values.begin(), values.end()) >= 0.0);
+	REQUIRE(*std::max_element(values.begin(), values.end()) < 1.0);
+	const auto stats{moments(values)};
+	REQUIRE(std::abs(stats.first - 0.5) < 0.005);
+	REQUIRE(std::abs(stats.second - (1.0 / 12.0)) < 0.002);
+}
+
+TEST_CASE("normal_t", "[prng]")
+{
+	const normal_t<double> standard{};
+	REQUIRE(standard.mean() == 0.0);
+	REQUIRE(standard.stddev() == 1.0);
+
+	std::vector<double> values(1000000U);
+	xoshiro256x8pp_t rng{std::array<uint64_t, 4>{{1U, 2U, 3U, 4U}}};
+	standard.fill(rng, values);
+	const auto stats{moments(values)};
+	REQUIRE(std::abs(stats.first) < 0.005);
+	REQUIRE(std::abs(stats.second - 1.0) < 0.01);
+
+	// Check the proportions of values in bands either side of the mean against the normal CDF, including the
+	// band past the start of the tail which the ziggurat samples separately
+	const auto fraction{[&](const double lower, const double upper)
+	{
+		return double(std::count_if(values.begin(), values.end(),
+			[&](const double value) { return value >= lower && value < upper; })) / double(values.size());
+	}};
+	const auto cdf{[](const double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); }};
+	for (const auto &band : std::vector<std::pair<double, double>>{{-1.0, 0.0}, {0.0, 1.0}, {1.0, 2.0},
+		{-3.0, -2.0}, {2.5, 3.0}})
+		REQUIRE(std::abs(fraction(band.first, band.second) - (cdf(band.second) - cdf(band.first))) < 0.002);
+	const auto tail{fraction(3.6541528853610088, 100.0) + fraction(-100.0, -3.6541528853610088)};
+	REQUIRE(std::abs(tail - (2.0 * cdf(-3.6541528853610088))) < 0.0001);
+
+	const normal_t<float> shifted{10.0F, 2.0F};
+	std::vector<float> floats(100000U);
+	shifted.fill(rng, floats);
+	const auto floatStats{moments(floats)};
+	REQUIRE(std::abs(floatStats.first - 10.0) < 0.05);
+	REQUIRE(std::abs(floatStats.second - 4.0) < 0.1);
+}
+
+TEST_CASE("exponential_t", "[prng]")
+{
+	const exponential_t<double> distribution{2.0};
+	REQUIRE(distribution.lambda() == 2.0);
+
+	std::vector<double> values(1000000U);
+	xoshiro256pp_t rng{{{1U, 2U, 3U, 4U}}};
+	distribution.fill(rng, values);
+	REQUIRE(*std::min_element(values.begin(), values.end()) >= 0.0);
+	const auto stats{moments(values)};
+	REQUIRE(std::abs(stats.first - 0.5) < 0.005);
+	REQUIRE(std::abs(stats.second - 0.25) < 0.005);
+
+	// P(X >= x) = exp(-lambda x), checked either side of the tail's start at 7.7 / lambda
+	for (const double x : {0.1, 0.5, 1.0, 2.0, 3.5, 4.0})
+	{
+		const auto above{double(std::count_if(values.begin(), values.end(),
+			[&](const double value) { return value >= x; })) / double(values.size())};
+		REQUIRE(std::abs(above - std::exp(-2.0 * x)) < 0.002);
+	}
+}
 
 /* vim: set ft=cpp ts=4 sw=4 noexpandtab: */
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 #include <errno.h>
 #ifndef _WIN32
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -10,7 +11,10 @@
 #endif
 #include <winsock2.h>
 #endif
+#include <array>
 #include <cstring>
+#include <thread>
+#include <vector>
 #include <substrate/socket>
 #include <catch2/catch_test_macros.hpp>
 
@@ -145,6 +149,88 @@ TEST_CASE("socket_t bad socket", "[socket_t]")
 	ASSERT_BAD_SOCKET;
 }
 
+#ifndef _WIN32
+TEST_CASE("socket_t vectored I/O", "[socket_t]")
+{
+	std::array<int, 2> pair{};
+	REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, pair.data()) == 0);
+	const socket_t writer{pair[0]};
+	const socket_t reader{pair[1]};
+
+	const std::array<uint8_t, 4> header{{'s', 'i', 'z', 'e'}};
+	const std::array<uint8_t, 7> payload{{'p', 'a', 'y', 'l', 'o', 'a', 'd'}};
+	const std::array<substrate::span<const uint8_t>, 2> writeBuffers
+		{{substrate::span<const uint8_t>{header}, substrate::span<const uint8_t>{payload}}};
+	REQUIRE(writer.writeVec(writeBuffers, nullptr) == 11);
+
+	std::array<uint8_t, 6> first{};
+	std::array<uint8_t, 5> second{};
+	const std::array<substrate::span<uint8_t>, 2> readBuffers
+		{{substrate::span<uint8_t>{first}, substrate::span<uint8_t>{second}}};
+	REQUIRE(reader.readVec(readBuffers, nullptr) == 11);
+	REQUIRE(memcmp(first.data(), "sizepa", first.size()) == 0);
+	REQUIRE(memcmp(second.data(), "yload", second.size()) == 0);
+
+	// The bool forms move everything or fail
+	REQUIRE(writer.writeVec(writeBuffers));
+	REQUIRE(reader.readVec(readBuffers));
+	REQUIRE(memcmp(first.data(), "sizepa", first.size()) == 0);
+	REQUIRE(memcmp(second.data(), "yload", second.size()) == 0);
+
+	const socket_t invalid{};
+	REQUIRE(invalid.writeVec(writeBuffers, nullptr) == -1);
+	REQUIRE(invalid.readVec(readBuffers, nullptr) == -1);
+	REQUIRE_FALSE(invalid.writeVec(writeBuffers));
+	REQUIRE_FALSE(invalid.readVec(readBuffers));
+}
+
+TEST_CASE("socket_t vectored I/O short transfers", "[socket_t]")
+{
+	// More than a small send buffer holds, split unevenly so short transfers land part way through buffers
+	std::vector<uint8_t> data(768U * 1024U);
+	for (size_t i{}; i < data.size(); ++i)
+		data[i] = uint8_t((i * 7U) ^ (i >> 10U));
+	const std::array<substrate::span<const uint8_t>, 3> writeBuffers
+	{{
+		{data.data(), 100003U},
+		{data.data() + 100003U, 300007U},
+		{data.data() + 400010U, data.size() - 400010U},
+	}};
+	const int sendBuffer{4096};
+
+	// A non-blocking socket with a small send buffer can't take it all in one go, so the raw form comes up short
+	{
+		std::array<int, 2> pair{};
+		REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, pair.data()) == 0);
+		const socket_t writer{pair[0]};
+		const socket_t reader{pair[1]};
+		REQUIRE(fcntl(writer, F_SETFL, fcntl(writer, F_GETFL) | O_NONBLOCK) == 0);
+		REQUIRE(setsockopt(writer, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer)) == 0);
+		const auto written{writer.writeVec(writeBuffers, nullptr)};
+		REQUIRE(written > 0);
+		REQUIRE(size_t(written) < data.size());
+	}
+
+	// The bool forms carry on through every short transfer until it's all moved
+	std::array<int, 2> pair{};
+	REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, pair.data()) == 0);
+	const socket_t writer{pair[0]};
+	const socket_t reader{pair[1]};
+	REQUIRE(setsockopt(writer, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer)) == 0);
+
+	std::vector<uint8_t> result(data.size());
+	const std::array<substrate::span<uint8_t>, 2> readBuffers
+		{{{result.data(), 65537U}, {result.data() + 65537U, result.size() - 65537U}}};
+	bool readOK{false};
+	std::thread readThread{[&]() { readOK = reader.readVec(readBuffers); }};
+	const bool writeOK{writer.writeVec(writeBuffers)};
+	readThread.join();
+	REQUIRE(writeOK);
+	REQUIRE(readOK);
+	REQUIRE(result == data);
+}
+#endif
+
 TEST_CASE("socket_t inheriting construction", "[socket_t]")
 {
 	const substrate::sockType_t socketFD{::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)};